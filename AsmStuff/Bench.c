@@ -0,0 +1,758 @@
+#include "common.h"
+
+#include "Memory/Memory.h"
+#include "List/List.h"
+
+#include <math.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define BENCH_REPS		20		// Default count of timed runs of each benchmark
+#define BENCH_WARMUP	3		// Default count of untimed runs before them
+#define BENCH_OBJECTS	10000	// Blocks allocated, or lists created, per run
+#define BENCH_SEARCHES	100		// Searches per run
+#define BENCH_ITEMS		100000	// Most data loaded into a list at once
+#define BENCH_MAXTHREADS 16		// Most threads a churn benchmark runs
+
+#define CHURN_ROUNDS 2000	// Rounds of allocation per thread per run
+#define CHURN_BURST	 16		// Blocks held at once per round
+
+typedef double (* BENCHMARK) (FLAGS Kind, Dword Arg, Dword * Ops);	// One run at an argument; returns seconds spent timed, or a negative value if unsupported
+
+typedef struct {
+	int Factor;	// Multiplier applied to each datum
+	int Sum;	// Sum of results
+} SCALE;
+
+typedef struct {
+	char const * Name;	// Name of operation
+	char const * Variant;	// Variant of operation, or NULL
+	BENCHMARK Body;		// Run of benchmark
+	FLAGS Kind;			// Settings the run is made with
+	Dword Args [5];		// Arguments to run at; a 0 ends them early
+} BENCH;
+
+void * Blocks [BENCH_OBJECTS];	// Blocks allocated in a run
+hLIST Lists [BENCH_OBJECTS];	// Lists created in a run
+int Items [BENCH_ITEMS];		// Data loaded into lists in one call
+
+int Sink;	// Receives values computed by callbacks, so they are not optimized away
+
+/********************************************************************
+*																	*
+*							Support									*
+*																	*
+********************************************************************/
+
+double Seconds (void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER C, F;	// Profiling variables
+
+	QueryPerformanceCounter (&C);
+	QueryPerformanceFrequency (&F);
+
+	return (double) C.QuadPart / (double) F.QuadPart;
+#else
+	struct timespec Now;// Monotonic time
+
+	clock_gettime (CLOCK_MONOTONIC, &Now);
+
+	return (double) Now.tv_sec + (double) Now.tv_nsec * 1e-9;
+#endif
+}
+
+RETCODE Setup (Dword PoolSize, FLAGS Settings)
+{
+	uMCONFIG M = {0};	// Configuration structure
+
+	M.PoolSize = PoolSize;	// Pool is sized for the run, but may grow past it
+	M.PoolLimit = 1 << 30;
+	M.Settings = Settings;
+
+	return MemInit (&M);
+}
+
+RETCODE Equal (void * This, void * Outer)
+{
+	return *(int*)This == *(int*)Outer;
+}
+
+RETCODE Scale (void * This, void * Outer)
+{
+	SCALE * S = (SCALE *) Outer;// Running result
+
+	int Value = *(int*) This, Round;// Datum, and loop variable
+
+	for (Round = 0; Round < 16; ++Round)	// Give each datum some work, as transforms do
+		Value = Value * S->Factor + Round;
+
+	S->Sum += Value;
+
+	return RETCODE_SUCCESS;
+}
+
+void Fold (void * Into, void * From)
+{
+	((SCALE *) Into)->Sum += ((SCALE *) From)->Sum;
+}
+
+RETCODE Odd (void * This, void * Outer)
+{
+	(void) Outer;	// Oddness needs no context
+
+	return *(int*)This & 1;
+}
+
+void * Identity (void * This)
+{
+	return This;
+}
+
+Dword Scramble (void * Key)
+{
+	return (Dword) *(int*) Key;
+}
+
+RETCODE Accumulate (void * This, void * Outer)
+{
+	Sink += *(int*) This * *(int*) Outer;
+
+	return RETCODE_SUCCESS;
+}
+
+/********************************************************************
+*																	*
+*							Allocation								*
+*																	*
+********************************************************************/
+
+double AllocRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	int index;	// Loop variable
+
+	if (Kind == 0 && Setup (BENCH_OBJECTS * (Arg + 64), 0) != RETCODE_SUCCESS) return -1;
+
+	Start = Seconds ();
+	if (Kind == 0) for (index = 0; index < BENCH_OBJECTS; ++index) Blocks [index] = MemAlloc (Arg, 0);
+	else for (index = 0; index < BENCH_OBJECTS; ++index) Blocks [index] = malloc (Arg);
+	seconds = Seconds () - Start;
+
+	if (Kind == 0) MemTerm (NULL);
+	else for (index = 0; index < BENCH_OBJECTS; ++index) free (Blocks [index]);
+
+	*Ops = BENCH_OBJECTS;
+
+	return seconds;
+}
+
+double FreeRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	int index;	// Loop variable
+
+	if (Kind == 0 && Setup (BENCH_OBJECTS * (Arg + 64), 0) != RETCODE_SUCCESS) return -1;
+
+	if (Kind == 0) for (index = 0; index < BENCH_OBJECTS; ++index) Blocks [index] = MemAlloc (Arg, 0);
+	else for (index = 0; index < BENCH_OBJECTS; ++index) Blocks [index] = malloc (Arg);
+
+	Start = Seconds ();
+	if (Kind == 0) for (index = 0; index < BENCH_OBJECTS; ++index) MemFree (Blocks [index]);
+	else for (index = 0; index < BENCH_OBJECTS; ++index) free (Blocks [index]);
+	seconds = Seconds () - Start;
+
+	if (Kind == 0) MemTerm (NULL);
+
+	*Ops = BENCH_OBJECTS;
+
+	return seconds;
+}
+
+double BatchRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+
+	if (Setup (BENCH_OBJECTS * (Arg + 64), 0) != RETCODE_SUCCESS) return -1;
+
+	Start = Seconds ();
+	MemAllocBatch (BENCH_OBJECTS, Arg, Blocks, 0);
+	seconds = Seconds () - Start;
+
+	Start = Seconds ();
+	MemFreeBatch (Blocks, BENCH_OBJECTS);
+	if (Kind != 0) seconds = Seconds () - Start;	// Time the release instead
+
+	MemTerm (NULL);
+
+	*Ops = BENCH_OBJECTS;
+
+	return seconds;
+}
+
+#ifdef _WIN32
+DWORD WINAPI Churn (LPVOID Param)
+#else
+void * Churn (void * Param)
+#endif
+{
+	void * Held [CHURN_BURST];	// Blocks held this round
+	int round, index;	// Loop variables
+
+	for (round = 0; round < CHURN_ROUNDS; ++round)
+	{
+		if (Param != NULL)
+		{
+			for (index = 0; index < CHURN_BURST; ++index) Held [index] = malloc (sizeof(int) * (1 + (index & 7)));
+			for (index = 0; index < CHURN_BURST; ++index) free (Held [index]);
+		}
+
+		else
+		{
+			for (index = 0; index < CHURN_BURST; ++index) Held [index] = MemAlloc (sizeof(int) * (1 + (index & 7)), 0);
+			for (index = 0; index < CHURN_BURST; ++index) MemFree (Held [index]);
+		}
+	}
+
+	if (Param == NULL) MemThreadTerm ();
+
+	return 0;
+}
+
+double ChurnRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	void * Param = Kind != 0 ? (void *) &Sink : NULL;	// Tells the C runtime's threads apart
+	Dword index;// Loop variable
+#ifdef _WIN32
+	HANDLE Threads [BENCH_MAXTHREADS];	// Churning threads
+#else
+	pthread_t Threads [BENCH_MAXTHREADS];	// Churning threads
+#endif
+
+	if (Kind == 0 && Setup (1 << 24, MEM_THREADSAFE) != RETCODE_SUCCESS) return -1;
+
+	Start = Seconds ();
+#ifdef _WIN32
+	for (index = 0; index < Arg; ++index) Threads [index] = CreateThread (NULL, 0, Churn, Param, 0, NULL);
+	WaitForMultipleObjects (Arg, Threads, TRUE, INFINITE);
+#else
+	for (index = 0; index < Arg; ++index) pthread_create (&Threads [index], NULL, Churn, Param);
+	for (index = 0; index < Arg; ++index) pthread_join (Threads [index], NULL);
+#endif
+	seconds = Seconds () - Start;
+
+#ifdef _WIN32
+	for (index = 0; index < Arg; ++index) CloseHandle (Threads [index]);
+#endif
+
+	if (Kind == 0) MemTerm (NULL);
+
+	*Ops = Arg * CHURN_ROUNDS * CHURN_BURST;
+
+	return seconds;
+}
+
+/********************************************************************
+*																	*
+*							Lists									*
+*																	*
+********************************************************************/
+
+hLIST Fill (FLAGS Kind, Dword Arg)
+{
+	hLIST List = ListCreate (Arg, sizeof(int), Kind);	// List being filled
+	int index;	// Loop variable
+
+	if (List != NULL) for (index = 0; index < (int) Arg; ++index) ListToBack (List, &index);
+
+	return List;
+}
+
+double ListCreateRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	int index;	// Loop variable
+
+	if (Setup (1 << 24, 0) != RETCODE_SUCCESS) return -1;
+
+	Start = Seconds ();
+	for (index = 0; index < BENCH_OBJECTS; ++index) Lists [index] = ListCreate (Arg, sizeof(int), Kind);
+	seconds = Seconds () - Start;
+
+	if (Lists [0] == NULL) seconds = -1;	// Settings are unsupported
+
+	else for (index = 0; index < BENCH_OBJECTS; ++index) ListDestroy (Lists [index]);
+
+	MemTerm (NULL);
+
+	*Ops = BENCH_OBJECTS;
+
+	return seconds;
+}
+
+double ListToFrontRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being filled
+	int index;	// Loop variable
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = ListCreate (Arg, sizeof(int), Kind)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	for (index = 0; index < (int) Arg; ++index) ListToFront (List, &index);
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+double ListAppendArrayRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being filled
+	Dword index;// Loop variable
+
+	if (Arg > BENCH_ITEMS || Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = ListCreate (Arg, sizeof(int), Kind)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	for (index = 0; index < Arg; ++index) Items [index] = (int) index;
+
+	Start = Seconds ();
+	ListAppendArray (List, Items, Arg);
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+double ListExecuteRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being processed
+	int Factor = 3;	// Context of callback
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = Fill (Kind, Arg)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	ListExecute (List, Accumulate, &Factor);
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+double ListExecuteParallelRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being processed
+	SCALE S = { 3, 0 };	// Context of callback
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = Fill (Kind, Arg)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	ListExecuteParallel (List, Scale, &S, sizeof(S), Fold, 0);
+	seconds = Seconds () - Start;
+
+	Sink += S.Sum;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+double ListSearchRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being searched
+	Dword Seed = 17;// Key generator state
+	int index, Key;	// Loop variable, and key sought
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = Fill (Kind, Arg)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	for (index = 0; index < BENCH_SEARCHES; ++index)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		Key = (int)((Seed >> 8) % Arg);
+
+		if (ListSearch (List, Equal, &Key) != NULL) ++Sink;
+	}
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = BENCH_SEARCHES;
+
+	return seconds;
+}
+
+double ListSearchKeyRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being searched
+	Dword Seed = 17;// Key generator state
+	int index, Key;	// Loop variable, and key sought
+
+	if (Setup (Arg * 96 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = ListCreateIndexed (Arg, sizeof(int), Kind, Identity, Scramble)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	for (index = 0; index < (int) Arg; ++index) ListToBack (List, &index);
+
+	Start = Seconds ();
+	for (index = 0; index < BENCH_SEARCHES; ++index)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		Key = (int)((Seed >> 8) % Arg);
+
+		if (ListSearchKey (List, Equal, &Key) != NULL) ++Sink;
+	}
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = BENCH_SEARCHES;
+
+	return seconds;
+}
+
+double ListDeleteIfRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being pruned
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = Fill (Kind, Arg)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	Sink += ListDeleteIf (List, Odd, NULL);
+	seconds = Seconds () - Start;
+
+	ListDestroy (List);
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+double ListDestroyRun (FLAGS Kind, Dword Arg, Dword * Ops)
+{
+	double Start, seconds;	// Profiling variables
+	hLIST List;	// List being destroyed
+
+	if (Setup (Arg * 64 + (1 << 16), 0) != RETCODE_SUCCESS) return -1;
+
+	if ((List = Fill (Kind, Arg)) == NULL)	// Settings are unsupported
+	{
+		MemTerm (NULL);
+
+		return -1;
+	}
+
+	Start = Seconds ();
+	ListDestroy (List);
+	seconds = Seconds () - Start;
+
+	MemTerm (NULL);
+
+	*Ops = Arg;
+
+	return seconds;
+}
+
+/********************************************************************
+*																	*
+*							Registry								*
+*																	*
+********************************************************************/
+
+BENCH Benches [] = {
+	{ "MemAlloc",		NULL,		AllocRun,		0,			{ 16, 64, 256, 4096 } },
+	{ "malloc",			NULL,		AllocRun,		1,			{ 16, 64, 256, 4096 } },
+	{ "MemFree",		NULL,		FreeRun,		0,			{ 16, 64, 256, 4096 } },
+	{ "free",			NULL,		FreeRun,		1,			{ 16, 64, 256, 4096 } },
+	{ "MemAllocBatch",	NULL,		BatchRun,		0,			{ 16, 64, 256 } },
+	{ "MemFreeBatch",	NULL,		BatchRun,		1,			{ 16, 64, 256 } },
+	{ "MemChurn",		"threads",	ChurnRun,		0,			{ 1, 2, 4, 8, 16 } },
+	{ "mallocChurn",	"threads",	ChurnRun,		1,			{ 1, 2, 4, 8, 16 } },
+	{ "ListCreate",		"static",	ListCreateRun,	0,			{ 5 } },
+	{ "ListCreate",		"dynamic",	ListCreateRun,	L_DYNAMIC,	{ 5 } },
+	{ "ListCreate",		"slab",		ListCreateRun,	L_SLAB,		{ 5 } },
+	{ "ListCreate",		"unrolled",	ListCreateRun,	L_UNROLLED,	{ 5 } },
+	{ "ListCreate",		"ring",		ListCreateRun,	L_RING | L_DYNAMIC, { 5 } },
+	{ "ListToFront",	"static",	ListToFrontRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListToFront",	"dynamic",	ListToFrontRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListToFront",	"slab",		ListToFrontRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListToFront",	"unrolled",	ListToFrontRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListToFront",	"ring",		ListToFrontRun,	L_RING | L_DYNAMIC, { 100, 10000, 100000 } },
+	{ "ListAppendArray",	"static",	ListAppendArrayRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListAppendArray",	"dynamic",	ListAppendArrayRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListAppendArray",	"slab",		ListAppendArrayRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListAppendArray",	"unrolled",	ListAppendArrayRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListAppendArray",	"ring",		ListAppendArrayRun,	L_RING | L_DYNAMIC, { 100, 10000, 100000 } },
+	{ "ListExecute",	"static",	ListExecuteRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListExecute",	"dynamic",	ListExecuteRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListExecute",	"slab",		ListExecuteRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListExecute",	"unrolled",	ListExecuteRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListExecute",	"ring",		ListExecuteRun,	L_RING | L_DYNAMIC, { 100, 10000, 100000 } },
+	{ "ListExecuteParallel","static",	ListExecuteParallelRun,	0,			{ 10000, 100000, 1000000 } },
+	{ "ListExecuteParallel","dynamic",	ListExecuteParallelRun,	L_DYNAMIC,	{ 10000, 100000, 1000000 } },
+	{ "ListExecuteParallel","slab",		ListExecuteParallelRun,	L_SLAB,		{ 10000, 100000, 1000000 } },
+	{ "ListExecuteParallel","unrolled",	ListExecuteParallelRun,	L_UNROLLED,	{ 10000, 100000, 1000000 } },
+	{ "ListExecuteParallel","ring",		ListExecuteParallelRun,	L_RING | L_DYNAMIC, { 10000, 100000, 1000000 } },
+	{ "ListSearch",		"static",	ListSearchRun,	0,			{ 100, 10000 } },
+	{ "ListSearch",		"dynamic",	ListSearchRun,	L_DYNAMIC,	{ 100, 10000 } },
+	{ "ListSearch",		"slab",		ListSearchRun,	L_SLAB,		{ 100, 10000 } },
+	{ "ListSearch",		"unrolled",	ListSearchRun,	L_UNROLLED,	{ 100, 10000 } },
+	{ "ListSearch",		"ring",		ListSearchRun,	L_RING | L_DYNAMIC, { 100, 10000 } },
+	{ "ListSearchKey",	"static",	ListSearchKeyRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListSearchKey",	"dynamic",	ListSearchKeyRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListSearchKey",	"slab",		ListSearchKeyRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListSearchKey",	"unrolled",	ListSearchKeyRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListDeleteIf",	"static",	ListDeleteIfRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListDeleteIf",	"dynamic",	ListDeleteIfRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListDeleteIf",	"slab",		ListDeleteIfRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListDeleteIf",	"unrolled",	ListDeleteIfRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListDeleteIf",	"ring",		ListDeleteIfRun,	L_RING | L_DYNAMIC, { 100, 10000, 100000 } },
+	{ "ListDestroy",	"static",	ListDestroyRun,	0,			{ 100, 10000, 100000 } },
+	{ "ListDestroy",	"dynamic",	ListDestroyRun,	L_DYNAMIC,	{ 100, 10000, 100000 } },
+	{ "ListDestroy",	"slab",		ListDestroyRun,	L_SLAB,		{ 100, 10000, 100000 } },
+	{ "ListDestroy",	"unrolled",	ListDestroyRun,	L_UNROLLED,	{ 100, 10000, 100000 } },
+	{ "ListDestroy",	"ring",		ListDestroyRun,	L_RING | L_DYNAMIC, { 100, 10000, 100000 } }
+};
+
+/********************************************************************
+*																	*
+*							Statistics								*
+*																	*
+********************************************************************/
+
+int Compare (void const * First, void const * Second)
+{
+	double A = *(double const *) First, B = *(double const *) Second;	// Samples compared
+
+	return A < B ? -1 : A > B;
+}
+
+double Percentile (double const * Sorted, int Count, double Rank)
+{
+	int index = (int) ceil (Rank / 100.0 * Count) - 1;	// Nearest rank
+
+	return Sorted [index < 0 ? 0 : index];
+}
+
+void Record (FILE * fp, char const * Lead, char const * Name, int Family, int Instance, int nReps, int Rep, Dword Iterations, double Value)
+{
+	/* One timed run, in Google Benchmark's layout; Bench times wall-clock only, so CPU time repeats it */
+	fprintf (fp, "%s\n    { \"name\": \"%s\", \"family_index\": %d, \"per_family_instance_index\": %d, \"run_name\": \"%s\", \"run_type\": \"iteration\", \"repetitions\": %d, \"repetition_index\": %d, \"threads\": 1, \"iterations\": %lu, \"real_time\": %.9g, \"cpu_time\": %.9g, \"time_unit\": \"ns\" }",
+			 Lead, Name, Family, Instance, Name, nReps, Rep, (unsigned long) Iterations, Value, Value);
+}
+
+void Aggregate (FILE * fp, char const * Name, int Family, int Instance, int nReps, char const * Statistic, char const * Unit, double Value)
+{
+	/* One statistic of the timed runs, as a Google Benchmark aggregate; it always follows the runs */
+	fprintf (fp, ",\n    { \"name\": \"%s_%s\", \"family_index\": %d, \"per_family_instance_index\": %d, \"run_name\": \"%s\", \"run_type\": \"aggregate\", \"repetitions\": %d, \"threads\": 1, \"aggregate_name\": \"%s\", \"aggregate_unit\": \"%s\", \"iterations\": %d, \"real_time\": %.9g, \"cpu_time\": %.9g, \"time_unit\": \"ns\" }",
+			 Name, Statistic, Family, Instance, Name, nReps, Statistic, Unit, nReps, Value, Value);
+}
+
+int main (int argc, char * argv [])
+{
+	char const * Filter = NULL, * JsonFile = NULL;	// Benchmarks to run, and file receiving results
+	char Name [64];	// Full name of benchmark
+	int nReps = BENCH_REPS, nWarmup = BENCH_WARMUP, nRun = 0;	// Run counts, and count of benchmarks reported
+	int nFamily = 0, nInstance;	// Operations and variants reported, and arguments reported of the current one
+	double * Samples;	// Nanoseconds per operation of each timed run
+	FILE * fp = NULL;	// JSON output
+	int index, arg, rep;// Loop variables
+
+	for (index = 1; index < argc; ++index)	// Read options
+	{
+		if (!strcmp (argv [index], "--filter") && index + 1 < argc) Filter = argv [++index];
+
+		else if (!strcmp (argv [index], "--reps") && index + 1 < argc) nReps = atoi (argv [++index]);
+
+		else if (!strcmp (argv [index], "--warmup") && index + 1 < argc) nWarmup = atoi (argv [++index]);
+
+		else if (!strcmp (argv [index], "--json") && index + 1 < argc) JsonFile = argv [++index];
+
+		else
+		{
+			printf ("Usage: Bench [--filter text] [--reps count] [--warmup count] [--json file]\n");
+
+			return 1;
+		}
+	}
+
+	if (nReps < 1) nReps = 1;
+
+	Samples = (double *) malloc (nReps * sizeof(double));
+
+	if (JsonFile != NULL)
+	{
+		fp = !strcmp (JsonFile, "-") ? stdout : fopen (JsonFile, "wt");
+
+		if (fp == NULL)
+		{
+			printf ("Unable to open %s\n", JsonFile);
+
+			return 1;
+		}
+
+		fprintf (fp, "{\n  \"context\": { \"repetitions\": %d, \"warmup\": %d, \"objects\": %d, \"pointer_bytes\": %d },\n  \"benchmarks\": [",
+				 nReps, nWarmup, BENCH_OBJECTS, (int) sizeof(void *));
+	}
+
+	if (fp != stdout) printf ("%-40s %6s %10s %10s %10s %10s %8s\n", "Benchmark (ns/op)", "reps", "mean", "median", "p90", "p99", "cv");
+
+	for (index = 0; index < (int)(sizeof Benches / sizeof(BENCH)); ++index)
+	{
+		BENCH * Bench = Benches + index;	// Current benchmark
+
+		for (arg = 0, nInstance = 0; arg < 5 && Bench->Args [arg] != 0; ++arg)
+		{
+			double Mean = 0, Deviation = 0, seconds = 0;	// Statistics of samples
+			Dword Ops = 1;	// Operations per run
+
+			if (Bench->Variant != NULL) sprintf (Name, "%s/%s/%lu", Bench->Name, Bench->Variant, (unsigned long) Bench->Args [arg]);
+
+			else sprintf (Name, "%s/%lu", Bench->Name, (unsigned long) Bench->Args [arg]);
+
+			if (Filter != NULL && strstr (Name, Filter) == NULL) continue;
+
+			/* Warm caches and pages up, then time each run on its own */
+			for (rep = 0; rep < nWarmup && seconds >= 0; ++rep) seconds = Bench->Body (Bench->Kind, Bench->Args [arg], &Ops);
+
+			for (rep = 0; rep < nReps && seconds >= 0; ++rep)
+			{
+				seconds = Bench->Body (Bench->Kind, Bench->Args [arg], &Ops);
+
+				Samples [rep] = seconds * 1e9 / Ops;
+				Mean += Samples [rep];
+			}
+
+			if (seconds < 0)
+			{
+				if (fp != stdout) printf ("%-40s requires the portable backend\n", Name);
+
+				continue;
+			}
+
+			Mean /= nReps;
+
+			for (rep = 0; rep < nReps; ++rep) Deviation += (Samples [rep] - Mean) * (Samples [rep] - Mean);
+
+			Deviation = nReps > 1 ? sqrt (Deviation / (nReps - 1)) : 0;
+
+			if (fp != NULL)	// Record runs in the order they were timed
+				for (rep = 0; rep < nReps; ++rep)
+					Record (fp, nRun != 0 || rep != 0 ? "," : "", Name, nFamily, nInstance, nReps, rep, Ops, Samples [rep]);
+
+			qsort (Samples, nReps, sizeof(double), Compare);
+
+			if (fp != stdout) printf ("%-40s %6d %10.2f %10.2f %10.2f %10.2f %7.1f%%\n", Name, nReps, Mean,
+									  Percentile (Samples, nReps, 50), Percentile (Samples, nReps, 90), Percentile (Samples, nReps, 99), Mean != 0 ? 100 * Deviation / Mean : 0);
+
+			if (fp != NULL)	// Record statistics as aggregates of the runs
+			{
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "mean", "time", Mean);
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "median", "time", Percentile (Samples, nReps, 50));
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "stddev", "time", Deviation);
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "cv", "percentage", Mean != 0 ? Deviation / Mean : 0);
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "p90", "time", Percentile (Samples, nReps, 90));
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "p99", "time", Percentile (Samples, nReps, 99));
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "min", "time", Samples [0]);
+				Aggregate (fp, Name, nFamily, nInstance, nReps, "max", "time", Samples [nReps - 1]);
+			}
+
+			++nRun;
+			++nInstance;
+		}
+
+		if (nInstance != 0) ++nFamily;
+	}
+
+	if (fp != NULL)
+	{
+		fprintf (fp, "\n  ]\n}\n");
+
+		if (fp != stdout) fclose (fp);
+	}
+
+	free (Samples);
+
+	return 0;
+}
@@ -3,8 +3,22 @@
 #include "Memory\Memory.h"
 #include "List\List.h"
 
+#define CHURN_ROUNDS 20000	// Rounds of allocation per thread
+#define CHURN_BURST	 16		// Blocks held at once per round
+
+#define VECTOR_ROUNDS 100		// Rounds of vector growth
+#define VECTOR_COUNT  8			// Vectors grown side by side
+#define VECTOR_LIMIT  0x10000	// Bytes each vector grows to
+
+#define TRACE_SLOTS	4000	// Allocations live at once in fragmentation trace
+#define TRACE_STEPS	400000	// Steps of fragmentation trace
+
 int I [500];
 
+void * Slots [TRACE_SLOTS];	// Allocations live in fragmentation trace
+
+char const * Policies [] = { "first fit", "next fit", "best fit", "address fit" };	// Names of placement policies
+
 RETCODE Equal (void * This, void * Outer)
 {
 	return *(int*)This == *(int*)Outer;
@@ -20,10 +34,54 @@ RETCODE PrintMult (void * This, void * Outer)
 	return RETCODE_SUCCESS;
 }
 
+DWORD WINAPI Churn (LPVOID Param)
+{
+	void * Held [CHURN_BURST];	// Blocks held this round
+	int round, index;	// Loop variables
+
+	for (round = 0; round < CHURN_ROUNDS; ++round)
+	{
+		for (index = 0; index < CHURN_BURST; ++index) Held [index] = MemAlloc (sizeof(int) * (1 + (index & 7)), 0);
+		for (index = 0; index < CHURN_BURST; ++index) MemFree (Held [index]);
+	}
+
+	MemThreadTerm ();
+
+	return 0;
+}
+
+void Fragment (void)
+{
+	Dword Seed = 21;// Trace generator state
+	int step, slot;	// Loop variables
+
+	/* Mostly small objects, with the occasional large buffer, freed in random order */
+	for (step = 0; step < TRACE_STEPS; ++step)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		slot = (Seed >> 8) % TRACE_SLOTS;
+
+		if (Slots [slot] != NULL)
+		{
+			MemFree (Slots [slot]);
+
+			Slots [slot] = NULL;
+		}
+
+		else Slots [slot] = MemAlloc ((Seed >> 4) % 8 != 0 ? 16 + (Seed >> 12) % 200 : 1000 + (Seed >> 10) % 20000, 0);
+	}
+}
+
 void main (void)
 {
-	uMCONFIG M;	// Configuration structure
-	int index;	// Loop variable
+	uMCONFIG M = {0};	// Configuration structure
+	int index, round;	// Loop variables
+	int nThreads;	// Count of threads sharing memory
+	HANDLE Threads [16];// Threads used to test thread-safe memory
+	void * V [VECTOR_COUNT], * New;	// Growing vectors
+	Dword Size;	// Current size of vectors
+	uMSTATS Stats;	// Memory statistics
+	char MapFile [16];	// Name of fragmentation map
 	LARGE_INTEGER C1, C2, D;// Profiling variables
 	double seconds, Freq;	// Profiler output variables
 	int * A [9000];	// Memory to allocate
@@ -60,6 +118,22 @@ void main (void)
 	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
 	fprintf (fp, "With MemFree:  %f seconds, %.8f p/int\n", seconds, seconds / N);
 
+	/* Test speed of MemAllocBatch */
+	QueryPerformanceCounter (&C1);
+	MemAllocBatch (N, sizeof(int), (void **) A, 0);
+	QueryPerformanceCounter (&C2);
+
+	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+	fprintf (fp, "With MemAllocBatch: %f seconds, %.8f p/int\n", seconds, seconds / N);
+
+	/* Test speed of MemFreeBatch */
+	QueryPerformanceCounter (&C1);
+	MemFreeBatch ((void **) A, N);
+	QueryPerformanceCounter (&C2);
+
+	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+	fprintf (fp, "With MemFreeBatch:  %f seconds, %.8f p/int\n", seconds, seconds / N);
+
 	/* Test speed of malloc */
 	QueryPerformanceCounter (&C1);
 	for (index = 0; index < N; ++index)	A [index] = (int *) malloc (sizeof(int));
@@ -133,4 +207,160 @@ void main (void)
 
 	/* Terminate memory; output results to file */
 	MemTerm ("Mem.txt");
+
+	fp = fopen ("Log.txt","at");
+
+	/* Initialize thread-safe memory; leave room for every thread's caches */
+	M.PoolSize = 1 << 24;
+	M.Settings = MEM_THREADSAFE;
+
+	if (MemInit (&M) == RETCODE_SUCCESS)
+	{
+		fprintf (fp, "%d allocations per thread:\n", CHURN_ROUNDS * CHURN_BURST);
+
+		/* Test throughput of MemAlloc and MemFree across threads */
+		for (nThreads = 1; nThreads <= 16; nThreads *= 2)
+		{
+			QueryPerformanceCounter (&C1);
+			for (index = 0; index < nThreads; ++index) Threads [index] = CreateThread (NULL, 0, Churn, NULL, 0, NULL);
+			WaitForMultipleObjects (nThreads, Threads, TRUE, INFINITE);
+			QueryPerformanceCounter (&C2);
+
+			for (index = 0; index < nThreads; ++index) CloseHandle (Threads [index]);
+
+			seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+			fprintf (fp, "With %2d threads: %f seconds, %.0f allocs+frees/s\n", nThreads, seconds, (double) nThreads * CHURN_ROUNDS * CHURN_BURST / seconds);
+		}
+
+		MemTerm ("MemThreads.txt");
+	}
+
+	else fprintf (fp, "Thread-safe memory requires the portable backend (MEM_PORTABLE)\n");
+
+	fprintf (fp, "%d allocations on one thread:\n", CHURN_ROUNDS * CHURN_BURST);
+
+	/* Test MemAlloc and MemFree churn, coalescing at once, then deferring coalescing */
+	for (index = 0; index < 2; ++index)
+	{
+		M.PoolSize = 1 << 20;
+		M.Settings = index == 0 ? 0 : MEM_DEFER;
+
+		if (MemInit (&M) != RETCODE_SUCCESS)
+		{
+			fprintf (fp, "Deferred coalescing requires the portable backend (MEM_PORTABLE)\n");
+
+			continue;
+		}
+
+		QueryPerformanceCounter (&C1);
+		Churn (NULL);
+		QueryPerformanceCounter (&C2);
+
+		MemTerm (NULL);
+
+		seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+		fprintf (fp, "With %s coalescing: %f seconds, %.0f allocs+frees/s\n", index == 0 ? "immediate" : "deferred ", seconds, (double) CHURN_ROUNDS * CHURN_BURST / seconds);
+	}
+
+	/* Initialize memory; leave room for vectors and the gaps they leave behind */
+	M.PoolSize = 1 << 22;
+	M.Settings = 0;
+	MemInit (&M);
+
+	fprintf (fp, "%d rounds of %d vectors doubled to %d bytes:\n", VECTOR_ROUNDS, VECTOR_COUNT, VECTOR_LIMIT);
+
+	/* Test speed of MemRealloc on doubling vectors */
+	QueryPerformanceCounter (&C1);
+	for (round = 0; round < VECTOR_ROUNDS; ++round)
+	{
+		for (index = 0; index < VECTOR_COUNT; ++index) V [index] = MemAlloc (16, 0);
+		for (Size = 32; Size <= VECTOR_LIMIT; Size *= 2)
+			for (index = 0; index < VECTOR_COUNT; ++index) V [index] = MemRealloc (V [index], Size);
+		for (index = 0; index < VECTOR_COUNT; ++index) MemFree (V [index]);
+	}
+	QueryPerformanceCounter (&C2);
+
+	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+	fprintf (fp, "With MemRealloc:        %f seconds\n", seconds);
+
+	/* Test speed of MemAlloc, copy, and MemFree on doubling vectors */
+	QueryPerformanceCounter (&C1);
+	for (round = 0; round < VECTOR_ROUNDS; ++round)
+	{
+		for (index = 0; index < VECTOR_COUNT; ++index) V [index] = MemAlloc (16, 0);
+		for (Size = 32; Size <= VECTOR_LIMIT; Size *= 2)
+			for (index = 0; index < VECTOR_COUNT; ++index)
+			{
+				New = MemAlloc (Size, 0);
+				memcpy (New, V [index], Size / 2);
+				MemFree (V [index]);
+				V [index] = New;
+			}
+		for (index = 0; index < VECTOR_COUNT; ++index) MemFree (V [index]);
+	}
+	QueryPerformanceCounter (&C2);
+
+	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+	fprintf (fp, "With MemAlloc/MemFree:  %f seconds\n", seconds);
+
+	/* Test speed of realloc on doubling vectors */
+	QueryPerformanceCounter (&C1);
+	for (round = 0; round < VECTOR_ROUNDS; ++round)
+	{
+		for (index = 0; index < VECTOR_COUNT; ++index) V [index] = malloc (16);
+		for (Size = 32; Size <= VECTOR_LIMIT; Size *= 2)
+			for (index = 0; index < VECTOR_COUNT; ++index) V [index] = realloc (V [index], Size);
+		for (index = 0; index < VECTOR_COUNT; ++index) free (V [index]);
+	}
+	QueryPerformanceCounter (&C2);
+
+	seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+	fprintf (fp, "With realloc:           %f seconds\n", seconds);
+
+	/* Report how the vectors left the pool */
+	MemGetStats (NULL, &Stats);
+
+	fprintf (fp, "Peak bytes used: %lu, free blocks: %lu, largest free: %lu, fragmentation: %.3f\n",
+			 (unsigned long) Stats.PeakBytes, (unsigned long) Stats.nFree, (unsigned long) Stats.LargestFree, Stats.Fragmentation);
+
+	MemTerm ("MemVectors.txt");
+
+	/* Initialize memory; leave the trace room to fragment */
+	M.PoolSize = 1 << 25;
+
+	fprintf (fp, "Fragmentation trace of %d steps:\n", TRACE_STEPS);
+
+	/* Test fragmentation under each placement policy */
+	for (M.Placement = MEM_FIRST_FIT; M.Placement <= MEM_ADDRESS_FIT; ++M.Placement)
+	{
+		if (MemInit (&M) != RETCODE_SUCCESS)
+		{
+			fprintf (fp, "With %-11s: requires the portable backend (MEM_PORTABLE)\n", Policies [M.Placement]);
+
+			continue;
+		}
+
+		QueryPerformanceCounter (&C1);
+		Fragment ();
+		QueryPerformanceCounter (&C2);
+
+		MemGetStats (NULL, &Stats);
+
+		seconds = (double)(C2.QuadPart - C1.QuadPart) * Freq;
+		fprintf (fp, "With %-11s: %f seconds, peak bytes: %lu, free blocks: %lu, fragmentation: %.3f, scan length: %.2f\n",
+				 Policies [M.Placement], seconds, (unsigned long) Stats.PeakBytes, (unsigned long) Stats.nFree, Stats.Fragmentation, Stats.ScanLength);
+
+		if (MemVerify (NULL) != RETCODE_SUCCESS) fprintf (fp, "Heap damaged by trace\n");
+
+		/* Export where the trace left its fragments */
+		sprintf (MapFile, "Map%lu.csv", (unsigned long) M.Placement);
+
+		MemExportMap (NULL, MapFile, MEM_MAP_CSV);
+
+		for (index = 0; index < TRACE_SLOTS; ++index) Slots [index] = NULL;
+
+		MemTerm (NULL);
+	}
+
+	fclose (fp);
 }
\ No newline at end of file
@@ -6,6 +6,1875 @@
 
 #include "i_List.h"
 
+#ifdef LIST_PORTABLE
+
+/********************************************************************
+*																	*
+*							Internals								*
+*																	*
+********************************************************************/
+
+#if defined(__GNUC__)
+	#define ListLowBit(bits)	__builtin_ctzl(bits)	// Index of lowest set bit
+	#define ListHighBit(bits)	(int)(sizeof(long) * 8 - 1 - __builtin_clzl(bits))	// Index of highest set bit
+#else
+	// Index of lowest set bit
+	PRIVATE int ListLowBit (Dword bits)
+	{
+		int index = 0;	// Bit index
+
+		while (!(bits & 1)) bits >>= 1, ++index;
+
+		return index;
+	}
+
+	// Index of highest set bit
+	PRIVATE int ListHighBit (Dword bits)
+	{
+		int index = 0;	// Bit index
+
+		while (bits >>= 1) ++index;
+
+		return index;
+	}
+#endif
+
+// Perform an operation on the occupied slots of an unrolled list's chunk
+PRIVATE void ListSweepChunk (ptLIST List, ptLISTCHUNK Chunk, EXECUTE Callback, void * Context)
+{
+	Pbyte Slots = LIST_SLOT(List, Chunk, 0);// Chunk's slots
+
+	Dword Used;	// Occupied slots not yet processed
+
+	if (Chunk->Used == ((Dword) 2 << (List->nSlots - 1)) - 1)	// Sweep full chunks straight through
+		for (Used = 0; Used < List->nSlots; ++Used) Callback (Slots + Used * List->Stride, Context);
+
+	else for (Used = Chunk->Used; Used != 0; Used &= Used - 1)
+		Callback (Slots + ListLowBit(Used) * List->Stride, Context);
+}
+
+// Address the slot holding a ring list's datum at a position from the front
+PRIVATE Pbyte ListRingSlot (ptLIST List, Dword Pos)
+{
+	if ((Pos += List->First) >= List->Capacity) Pos -= List->Capacity;	// Wrap around the end of the ring
+
+	return List->Ring + Pos * List->Stride;
+}
+
+// Find the position from the front of a ring list's datum
+PRIVATE Dword ListRingPos (ptLIST List, void * Datum)
+{
+	Dword Slot = (Dword)((Pbyte) Datum - List->Ring) / List->Stride;	// Slot holding datum
+
+	return Slot >= List->First ? Slot - List->First : Slot + List->Capacity - List->First;
+}
+
+/********************************************************************
+*																	*
+*							ListCreate								*
+*																	*
+********************************************************************/
+
+// Purpose:	Creates a list object
+// Input:	A node count, per-element size, and list settings
+// Return:	A handle to the new list, if successful; NULL otherwise
+
+ptLIST ListCreate (int nNodes, Dword SizeOfObject, FLAGS Settings)
+{
+	ptLIST List;// New list
+
+	if ((Settings & LIST_LAYOUTS) & ((Settings & LIST_LAYOUTS) - 1))	// Storage layouts exclude one another
+		return NULL;
+
+	if (Settings & (L_SLAB | L_UNROLLED))	// Slab and unrolled lists are dynamic
+		Settings |= L_DYNAMIC;
+
+	if (Settings & L_UNROLLED) List = ListUnrolledInit (SizeOfObject);
+
+	else if (Settings & L_RING) List = ListRingInit (nNodes, SizeOfObject, Settings & L_DYNAMIC);
+
+	else List = Settings & L_DYNAMIC ? ListDynamicInit (SizeOfObject) : ListStaticInit (nNodes, SizeOfObject);
+
+	if (List == NULL)	// Ascertain that initialization succeeded
+		return NULL;
+
+	List->Status = Settings;// Load list status
+
+	if (Settings & L_SLAB)	// If list draws nodes from a slab, create it
+	{
+		List->Slab = MemSlabCreate (SizeOfObject + NODE_SIZE, 0);
+
+		if (List->Slab == NULL)	// Ascertain that MemSlabCreate succeeded
+		{
+			MemFree (List);
+
+			return NULL;
+		}
+	}
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListCreateIndexed						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Creates a list object keeping a hash index of its data by key
+// Input:	A node count, per-element size, list settings, and routines yielding a datum's key and hashing a key
+// Return:	A handle to the new list, if successful; NULL otherwise
+
+ptLIST ListCreateIndexed (int nNodes, Dword SizeOfObject, FLAGS Settings, KEYOF Key, HASH Hash)
+{
+	ptLIST List;// New list
+
+	if (Settings & L_RING)	// Ring data move, so the index could not keep track of them
+		return NULL;
+
+	if ((List = ListCreate (nNodes, SizeOfObject, Settings)) == NULL)
+		return NULL;
+
+	List->Key = Key;// Load key routines
+	List->Hash = Hash;
+
+	if (ListIndexReserve (List, Settings & L_DYNAMIC ? 0 : nNodes) != RETCODE_SUCCESS)	// Size a static list's index for all its nodes
+	{
+		ListDestroy (List);
+
+		return NULL;
+	}
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListDestroy								*
+*																	*
+********************************************************************/
+
+// Purpose:	Destroys a list object
+// Input:	A list handle
+// Return:	A code indicative of the results of the destruction
+
+RETCODE ListDestroy (ptLIST List)
+{
+	if (List->Index != NULL)// Release index
+		MemFree (List->Index);
+
+	if (List->Skip != NULL)	// Release skip index
+		MemFree (List->Skip);
+
+	if (List->Status & L_SLAB)	// If list draws nodes from a slab, release them all at once
+		MemSlabDestroy (List->Slab);
+
+	else ListFlush (List);	// Empty list
+
+	MemFree (List);	// Free list memory
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListFront								*
+*																	*
+********************************************************************/
+
+// Purpose:	Retrieves the datum at the list's front
+// Input:	A list handle
+// Return:	Pointer to datum at front of list; NULL if the list is empty
+
+void * ListFront (ptLIST List)
+{
+	if (List->Status & L_UNROLLED)	// Return first slot of front chunk
+		return List->nNodes != 0 ? LIST_SLOT(List, List->Chunks, ListLowBit(List->Chunks->Used)) : NULL;
+
+	if (List->Status & L_RING)	// Return first slot of ring
+		return List->nNodes != 0 ? List->Ring + List->First * List->Stride : NULL;
+
+	return List->nNodes != 0 ? &List->Head [BASE_EXTENT] : NULL;
+	// Return head's data
+}
+
+
+/********************************************************************
+*																	*
+*							ListBack								*
+*																	*
+********************************************************************/
+
+// Purpose:	Retrieves the datum at the list's back
+// Input:	A list handle
+// Return:	Pointer to datum at back of list; NULL if the list is empty
+
+void * ListBack (ptLIST List)
+{
+	if (List->Status & L_UNROLLED)	// Return last slot of back chunk
+		return List->nNodes != 0 ? LIST_SLOT(List, List->Chunks->Prev, ListHighBit(List->Chunks->Prev->Used)) : NULL;
+
+	if (List->Status & L_RING)	// Return last occupied slot of ring
+		return List->nNodes != 0 ? ListRingSlot (List, List->nNodes - 1) : NULL;
+
+	return List->nNodes != 0 ? &List->Head->Prev [BASE_EXTENT] : NULL;
+	// Return data of node before head
+}
+
+
+/********************************************************************
+*																	*
+*							ListPrev								*
+*																	*
+********************************************************************/
+
+// Purpose:	Retrieves datum before given datum in list
+// Input:	A list handle, and pointer to reference datum
+// Return:	Pointer to datum in list before reference datum
+
+void * ListPrev (ptLIST List, void * Datum)
+{
+	if (List->Status & L_UNROLLED)	// Return nearest slot below in chunk, or last slot of last chunk
+	{
+		ptLISTCHUNK Chunk = LIST_CHUNK(List, Datum);// Chunk holding datum
+
+		Dword Below = Chunk->Used & (((Dword) 1 << LIST_SLOTOF(List, Chunk, Datum)) - 1);	// Occupied slots below datum's
+
+		if (Below == 0) Below = (Chunk = Chunk->Prev)->Used;
+
+		return LIST_SLOT(List, Chunk, ListHighBit(Below));
+	}
+
+	if (List->Status & L_RING)	// Return slot one position nearer the front, wrapping to the back
+	{
+		Dword Pos = ListRingPos (List, Datum);	// Position of datum
+
+		return ListRingSlot (List, (Pos != 0 ? Pos : (Dword) List->nNodes) - 1);
+	}
+
+	return &((ptLISTNODE) Datum - BASE_EXTENT)->Prev [BASE_EXTENT];
+	// Return data of last node
+}
+
+
+/********************************************************************
+*																	*
+*							ListNext								*
+*																	*
+********************************************************************/
+
+// Purpose:	Retrieves datum after given datum in list
+// Input:	A list handle, and pointer to reference datum
+// Return:	Pointer to datum in list after reference datum
+
+void * ListNext (ptLIST List, void * Datum)
+{
+	if (List->Status & L_UNROLLED)	// Return nearest slot above in chunk, or first slot of next chunk
+	{
+		ptLISTCHUNK Chunk = LIST_CHUNK(List, Datum);// Chunk holding datum
+
+		Dword Above = Chunk->Used & ~(((Dword) 2 << LIST_SLOTOF(List, Chunk, Datum)) - 1);	// Occupied slots above datum's
+
+		if (Above == 0) Above = (Chunk = Chunk->Next)->Used;
+
+		return LIST_SLOT(List, Chunk, ListLowBit(Above));
+	}
+
+	if (List->Status & L_RING)	// Return slot one position nearer the back, wrapping to the front
+	{
+		Dword Pos = ListRingPos (List, Datum) + 1;	// Position of next datum
+
+		return ListRingSlot (List, Pos != (Dword) List->nNodes ? Pos : 0);
+	}
+
+	return &((ptLISTNODE) Datum - BASE_EXTENT)->Next [BASE_EXTENT];
+	// Return data of next node
+}
+
+
+/********************************************************************
+*																	*
+*							ListToFront								*
+*																	*
+********************************************************************/
+
+// Purpose:	Adds an entry to the front of the list
+// Input:	A list handle, and pointer to datum to add
+// Return:	A code indicating the results of the addition
+
+RETCODE ListToFront (ptLIST List, void * Datum)
+{
+	ptLISTNODE Node;// Node to hold datum
+
+	if (List->Index != NULL && ListIndexReserve (List, 1) != RETCODE_SUCCESS)	// Make room in index first
+		return RETCODE_FAILURE;
+
+	if (List->Status & L_UNROLLED)	// Place datum below front chunk's first slot
+		return ListChunkAdd (List, Datum, TRUE);
+
+	if (List->Status & L_RING)	// Place datum in the slot before the front, growing a full ring
+	{
+		if ((Dword) List->nNodes == List->Capacity && (!(List->Status & L_DYNAMIC) || ListRingGrow (List) != RETCODE_SUCCESS))
+			return RETCODE_FAILURE;
+
+		List->First = (List->First != 0 ? List->First : List->Capacity) - 1;
+
+		++List->nNodes;	// Document addition of datum
+
+		memcpy (List->Ring + List->First * List->Stride, Datum, List->SizeOfObject);
+
+		return RETCODE_SUCCESS;
+	}
+
+	Node = ListTakeNode (List);
+
+	if (Node == NULL)	// Ascertain that a node was available
+		return RETCODE_FAILURE;
+
+	ListLinkNode (List, Node, Datum);	// Add node at back of ring
+
+	List->Head = Node;	// Then make it the head
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListToBack								*
+*																	*
+********************************************************************/
+
+// Purpose:	Adds an entry to the back of the list
+// Input:	A list handle, and pointer to datum to add
+// Return:	A code indicating the results of the addition
+
+RETCODE ListToBack (ptLIST List, void * Datum)
+{
+	ptLISTNODE Node;// Node to hold datum
+
+	if (List->Index != NULL && ListIndexReserve (List, 1) != RETCODE_SUCCESS)	// Make room in index first
+		return RETCODE_FAILURE;
+
+	if (List->Status & L_UNROLLED)	// Place datum above back chunk's last slot
+		return ListChunkAdd (List, Datum, FALSE);
+
+	if (List->Status & L_RING)	// Place datum in the slot after the back, growing a full ring
+	{
+		if ((Dword) List->nNodes == List->Capacity && (!(List->Status & L_DYNAMIC) || ListRingGrow (List) != RETCODE_SUCCESS))
+			return RETCODE_FAILURE;
+
+		memcpy (ListRingSlot (List, List->nNodes++), Datum, List->SizeOfObject);	// Document addition of datum
+
+		return RETCODE_SUCCESS;
+	}
+
+	Node = ListTakeNode (List);
+
+	if (Node == NULL)	// Ascertain that a node was available
+		return RETCODE_FAILURE;
+
+	ListLinkNode (List, Node, Datum);	// Add node at back of ring
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListPrependArray						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Adds a run of entries to the front of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+RETCODE ListPrependArray (ptLIST List, void * Data, Dword Count)
+{
+	return ListAddArray (List, (Pbyte) Data, Count, TRUE);
+	// Return results of addition
+}
+
+
+/********************************************************************
+*																	*
+*							ListAppendArray							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Adds a run of entries to the back of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+RETCODE ListAppendArray (ptLIST List, void * Data, Dword Count)
+{
+	return ListAddArray (List, (Pbyte) Data, Count, FALSE);
+	// Return results of addition
+}
+
+
+/********************************************************************
+*																	*
+*							ListDelete								*
+*																	*
+********************************************************************/
+
+// Purpose:	Deletes entry from list
+// Input:	A list handle, and pointer to datum to delete
+// Return:	No value is returned
+
+void ListDelete (ptLIST List, void * Datum)
+{
+	ptLISTNODE Node = (ptLISTNODE) Datum - BASE_EXTENT;	// Obtain the node preceding the datum
+
+	if (List->Index != NULL)// Take datum out of index
+		ListIndexRemove (List, Datum);
+
+	if (List->Status & L_UNROLLED)	// Vacate datum's slot; other data stay where they are
+	{
+		ptLISTCHUNK Chunk = LIST_CHUNK(List, Datum);// Chunk holding datum
+
+		Chunk->Used &= ~((Dword) 1 << LIST_SLOTOF(List, Chunk, Datum));
+
+		--List->nNodes;	// Document removal of datum
+
+		if (Chunk->Used == 0)	// Retire chunk once it empties
+			ListChunkDrop (List, Chunk);
+
+		return;
+	}
+
+	if (List->Status & L_RING)	// Close the datum's gap in the ring
+	{
+		ListRingRemove (List, ListRingPos (List, Datum));
+
+		return;
+	}
+
+	if (--List->nNodes == 0) List->Head = NULL;	// Document removal of node, reassigning the head if need be
+
+	else if (List->Head == Node) List->Head = Node->Next;
+
+	if (List->nSkip != 0) ListSkipDrop (List, Node, Node->Next);	// Node may be sampled by the skip index
+
+	Node->Prev->Next = Node->Next;	// Update nodes' connections
+	Node->Next->Prev = Node->Prev;
+
+	if (!(List->Status & L_DYNAMIC))// Bind node to free list
+	{
+		Node->Next = List->Free;
+		List->Free = Node;
+	}
+
+	else if (List->Status & L_SLAB) MemSlabFree (List->Slab, Node);	// Release node to slab
+
+	else MemFree (Node);// Release node memory
+}
+
+
+/********************************************************************
+*																	*
+*							ListDeleteKey							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Deletes an entry with a given key from list, through the index if the list keeps one
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	A code indicating whether an entry was deleted
+
+RETCODE ListDeleteKey (ptLIST List, EQUIVAL Callback, void * Key)
+{
+	void * Datum = ListSearchKey (List, Callback, Key);	// Datum to delete
+
+	if (Datum == NULL)	// Ascertain that an entry has the key
+		return RETCODE_FAILURE;
+
+	ListDelete (List, Datum);
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListDeleteIf							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Deletes every entry a routine picks out from list
+// Input:	A list handle, a routine returning nonzero for data to delete, and context to pass to routine
+// Return:	Count of entries deleted
+
+int ListDeleteIf (ptLIST List, EQUIVAL Callback, void * Context)
+{
+	ptLISTNODE Node = List->Head, Next;	// Node being tested, and its successor
+
+	void * Nodes [LIST_BATCH];	// Batch of nodes to release
+
+	Dword nBatch = 0;	// Count of nodes in batch
+
+	int nNodes = List->nNodes, index;	// Count of data before deletion, and loop variable
+
+	if (List->Status & L_UNROLLED)	// Vacate picked slots chunk by chunk, retiring chunks that empty
+	{
+		ptLISTCHUNK Chunk = List->Chunks, Following;// Chunk being tested, and its successor
+
+		Dword Used, Slot;	// Occupied slots not yet tested, and slot being tested
+
+		BOOL Last = FALSE;	// Whether chunk is the back one
+
+		if (Chunk != NULL) do {
+			Following = Chunk->Next;
+
+			Last = Following == List->Chunks;
+
+			for (Used = Chunk->Used; Used != 0; Used &= Used - 1)
+			{
+				Slot = ListLowBit(Used);
+
+				if (!Callback (LIST_SLOT(List, Chunk, Slot), Context)) continue;
+
+				if (List->Index != NULL) ListIndexRemove (List, LIST_SLOT(List, Chunk, Slot));
+
+				Chunk->Used &= ~((Dword) 1 << Slot);
+
+				--List->nNodes;	// Document removal of datum
+			}
+
+			if (Chunk->Used == 0)	// Retire chunk once it empties
+				ListChunkDrop (List, Chunk);
+
+			Chunk = Following;
+		} while (!Last);
+
+		return nNodes - List->nNodes;
+	}
+
+	if (List->Status & L_RING)	// Slide kept data toward the front in one pass
+	{
+		Dword Pos, Kept = 0;// Position being tested, and count of data kept
+
+		for (Pos = 0; Pos < (Dword) nNodes; ++Pos)
+		{
+			Pbyte Slot = ListRingSlot (List, Pos);	// Slot being tested
+
+			if (Callback (Slot, Context)) continue;
+
+			if (Kept != Pos) memcpy (ListRingSlot (List, Kept), Slot, List->SizeOfObject);
+
+			++Kept;
+		}
+
+		List->nNodes = Kept;// Document removal of data
+
+		return nNodes - List->nNodes;
+	}
+
+	for (index = 0; index < nNodes; ++index, Node = Next)	// Unlink picked nodes in one walk
+	{
+		Next = Node->Next;
+
+		if (!Callback (&Node [BASE_EXTENT], Context)) continue;
+
+		if (List->Index != NULL) ListIndexRemove (List, &Node [BASE_EXTENT]);
+
+		if (--List->nNodes == 0) List->Head = NULL;	// Document removal of node, reassigning the head if need be
+
+		else if (List->Head == Node) List->Head = Next;
+
+		if (List->nSkip != 0) ListSkipDrop (List, Node, Next);	// Node may be sampled by the skip index
+
+		Node->Prev->Next = Next;// Update nodes' connections
+		Next->Prev = Node->Prev;
+
+		if (!(List->Status & L_DYNAMIC))// Bind node to free list
+		{
+			Node->Next = List->Free;
+			List->Free = Node;
+		}
+
+		else if (List->Status & L_SLAB) MemSlabFree (List->Slab, Node);	// Release node to slab
+
+		else// Release nodes in batches, merging neighbouring nodes
+		{
+			Nodes [nBatch++] = Node;
+
+			if (nBatch == LIST_BATCH)
+			{
+				MemFreeBatch (Nodes, nBatch);
+
+				nBatch = 0;
+			}
+		}
+	}
+
+	if (nBatch != 0) MemFreeBatch (Nodes, nBatch);
+
+	return nNodes - List->nNodes;
+	// Return count of entries deleted
+}
+
+
+/********************************************************************
+*																	*
+*							ListFlush								*
+*																	*
+********************************************************************/
+
+// Purpose:	Flushes all entries from list
+// Input:	A list handle
+// Return:	No value is returned
+
+void ListFlush (ptLIST List)
+{
+	ptLISTNODE Node, Next;	// Node being released, and its successor
+
+	void * Nodes [LIST_BATCH];	// Batch of nodes to release
+
+	Dword nBatch = 0;	// Count of nodes in batch
+
+	if (List->Index != NULL)// Empty index
+		ZeroMemory(List->Index, List->IndexSize * sizeof(tLISTENTRY));
+
+	List->nSkip = 0;// Skip index samples nothing now
+
+	if (List->Status & L_UNROLLED)	// Release every chunk, spare included
+	{
+		while (List->Chunks != NULL)
+		{
+			ptLISTCHUNK Chunk = List->Chunks;	// Refer to front chunk
+
+			List->Chunks = Chunk->Next != Chunk ? Chunk->Next : NULL;
+
+			Chunk->Prev->Next = Chunk->Next;
+			Chunk->Next->Prev = Chunk->Prev;
+
+			MemFree (Chunk);
+		}
+
+		if (List->Spare != NULL) MemFree (List->Spare);
+
+		List->Spare = NULL;
+		List->nNodes = 0;	// Document flush
+
+		return;
+	}
+
+	if (List->Status & L_RING)	// Empty the ring; a dynamic ring releases its slots
+	{
+		if ((List->Status & L_DYNAMIC) && List->Ring != NULL)
+		{
+			MemFree (List->Ring);
+
+			List->Ring = NULL;
+			List->Capacity = 0;
+		}
+
+		List->nNodes = List->First = 0;	// Document flush
+
+		return;
+	}
+
+	if (List->nNodes != 0)	// Empty the ring
+	{
+		if (List->Status & L_SLAB)	// Return nodes to the slab
+		{
+			Node = List->Head;
+
+			do {
+				Next = Node->Next;
+
+				MemSlabFree (List->Slab, Node);
+
+				Node = Next;
+			} while (--List->nNodes != 0);
+		}
+
+		else// Bind final node to free list or reserve
+		{
+			List->Head->Prev->Next = List->Free;
+			List->Free = List->Head;
+
+			List->nNodes = 0;	// Document flush
+		}
+
+		List->Head = NULL;
+	}
+
+	if ((List->Status & (L_DYNAMIC | L_SLAB)) != L_DYNAMIC)	// Only dynamic lists with a reserve release it
+		return;
+
+	for (Node = List->Free, List->Free = NULL; Node != NULL; Node = Next)	// Release reserve in batches, merging neighbouring nodes
+	{
+		Next = Node->Next;
+
+		Nodes [nBatch++] = Node;
+
+		if (nBatch == LIST_BATCH || Next == NULL)
+		{
+			MemFreeBatch (Nodes, nBatch);
+
+			nBatch = 0;
+		}
+	}
+}
+
+
+/********************************************************************
+*																	*
+*							ListSearch								*
+*																	*
+********************************************************************/
+
+// Purpose:	Searches a linked list for a given datum
+// Input:	A list handle, an equivalence routine, and context to equat
+// Return:	Pointer to the datum if it exists; NULL otherwise
+
+void * ListSearch (ptLIST List, EQUIVAL Callback, void * Context)
+{
+	ptLISTNODE Node = List->Head;	// Node being tested
+
+	int index;	// Loop variable
+
+	if (List->Status & L_UNROLLED)	// Test occupied slots chunk by chunk
+	{
+		ptLISTCHUNK Chunk = List->Chunks;	// Chunk being tested
+
+		if (Chunk != NULL) do {
+			Dword Used;	// Occupied slots not yet tested
+
+			for (Used = Chunk->Used; Used != 0; Used &= Used - 1)
+			{
+				void * Datum = LIST_SLOT(List, Chunk, ListLowBit(Used));// Datum being tested
+
+				if (Callback (Datum, Context)) return Datum;// If test did not fail, item was found
+			}
+
+			Chunk = Chunk->Next;
+		} while (Chunk != List->Chunks);
+
+		return NULL;
+	}
+
+	if (List->Status & L_RING)	// Test slots in order, wrapping once at the end of the ring
+	{
+		Pbyte Slot = List->Ring + List->First * List->Stride;	// Slot being tested
+
+		Dword Run = List->Capacity - List->First;	// Slots left before the ring wraps
+
+		for (index = 0; index < List->nNodes; ++index)
+		{
+			if (Callback (Slot, Context)) return Slot;	// If test did not fail, item was found
+
+			Slot = --Run != 0 ? Slot + List->Stride : List->Ring;
+		}
+
+		return NULL;
+	}
+
+	for (index = 0; index < List->nNodes; ++index, Node = Node->Next)
+		if (Callback (&Node [BASE_EXTENT], Context)) return &Node [BASE_EXTENT];	// If test did not fail, item was found
+
+	return NULL;
+	// No item was found, so return NULL
+}
+
+
+/********************************************************************
+*																	*
+*							ListSearchKey							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Searches a list for a datum with a given key, through the index if the list keeps one
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	Pointer to a datum with the key if one exists, not necessarily the first; NULL otherwise
+
+void * ListSearchKey (ptLIST List, EQUIVAL Callback, void * Key)
+{
+	Dword Hash, Slot;	// Hash of key, and index slot being probed
+
+	if (List->Index == NULL)// Lists without an index are searched in order
+		return ListSearch (List, Callback, Key);
+
+	Hash = List->Hash (Key);
+
+	for (Slot = LIST_BUCKET(List, Hash); List->Index [Slot].Datum != NULL; Slot = (Slot + 1) & (List->IndexSize - 1))
+		if (List->Index [Slot].Hash == Hash && Callback (List->Index [Slot].Datum, Key)) return List->Index [Slot].Datum;
+
+	return NULL;
+	// No item was found, so return NULL
+}
+
+
+/********************************************************************
+*																	*
+*							ListIsEmpty								*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to determine whether list is empty
+// Input:	A list handle
+// Return:	A boolean indicating whether list is empty
+
+BOOL ListIsEmpty (ptLIST List)
+{
+	return List->nNodes == 0;
+	// Return whether list is empty
+}
+
+
+/********************************************************************
+*																	*
+*							ListIsFull								*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to determine whether list if full
+// Input:	A list handle
+// Return:	A boolean indicating whether list is full
+
+BOOL ListIsFull (ptLIST List)
+{
+	return List->nNodes == List->nMax;
+	// Return whether node count reached max
+}
+
+
+/********************************************************************
+*																	*
+*							ListNodeCount							*
+*																	*
+********************************************************************/
+
+// Purpose:	Retrieves a list's current node count
+// Input:	A list handle
+// Return:	Count of nodes in list
+
+int ListNodeCount (ptLIST List)
+{
+	return List->nNodes;
+	// Return node count
+}
+
+
+/********************************************************************
+*																	*
+*							ListExecute								*
+*																	*
+********************************************************************/
+
+// Purpose:	Performs an operation on all list elements
+// Input:	A list handle, an operation to execute, and optional context to pass to routine
+// Return:	No value is returned
+
+void ListExecute (ptLIST List, EXECUTE Callback, void * Context)
+{
+	ptLISTNODE Node = List->Head;	// Node being processed
+
+	int index;	// Loop variable
+
+	if (List->Status & L_UNROLLED)	// Visit occupied slots chunk by chunk
+	{
+		ptLISTCHUNK Chunk = List->Chunks;	// Chunk being processed
+
+		if (Chunk != NULL) do {
+			ListSweepChunk (List, Chunk, Callback, Context);
+
+			Chunk = Chunk->Next;
+		} while (Chunk != List->Chunks);
+
+		return;
+	}
+
+	if (List->Status & L_RING)	// Visit slots in order, wrapping once at the end of the ring
+	{
+		Pbyte Slot = List->Ring + List->First * List->Stride;	// Slot being processed
+
+		Dword Run = List->Capacity - List->First;	// Slots left before the ring wraps
+
+		for (index = 0; index < List->nNodes; ++index)
+		{
+			Callback (Slot, Context);
+
+			Slot = --Run != 0 ? Slot + List->Stride : List->Ring;
+		}
+
+		return;
+	}
+
+	for (index = 0; index < List->nNodes; ++index, Node = Node->Next)
+		Callback (&Node [BASE_EXTENT], Context);
+}
+
+
+/********************************************************************
+*																	*
+*							ListExecuteParallel						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Performs an operation on all list elements, splitting the list among several threads
+// Input:	A list handle, an operation to execute, context to pass to routine, size of context to give each thread a copy of, or 0
+//			to share it, a routine folding a thread's copy into the context, and count of threads, or 0 for one per processor
+// Return:	No value is returned
+
+void ListExecuteParallel (ptLIST List, EXECUTE Callback, void * Context, Dword SizeOfContext, REDUCE Reduce, int nThreads)
+{
+	tLISTPASS Pass;	// Pass shared among threads
+
+	tLISTWORKER Workers [LIST_THREADS];	// Threads taking part, the calling thread first
+
+	Pbyte Contexts = NULL;	// Threads' copies of context
+
+	Dword Pitch = (SizeOfContext + LIST_LINE - 1) & ~(Dword)(LIST_LINE - 1), index;	// Spacing of copies, and loop variable
+
+	void * Front = List->Status & L_UNROLLED ? (void *) List->Chunks : (void *) List->Head;	// Front node or chunk
+
+	if (nThreads <= 0) nThreads = ListCpuCount ();
+
+	if (nThreads > LIST_THREADS) nThreads = LIST_THREADS;
+
+	if (nThreads <= 1 || List->nNodes < LIST_PARALLEL)	// Small lists are not worth the threads
+	{
+		ListExecute (List, Callback, Context);
+
+		return;
+	}
+
+	if (!(List->Status & L_RING) && (List->nSkip == 0 || (Dword) List->nNodes > List->SkipBase * 2) && ListSkipBuild (List) != RETCODE_SUCCESS)
+	{
+		ListExecute (List, Callback, Context);	// Without a skip index, run through serially
+
+		return;
+	}
+
+	if (SizeOfContext != 0 && (Contexts = (Pbyte) MemAllocAligned (nThreads * Pitch, LIST_LINE, 0)) == NULL)
+	{
+		ListExecute (List, Callback, Context);	// Without copies, run through serially
+
+		return;
+	}
+
+	Pass.List = List;	// Set pass up
+	Pass.Callback = Callback;
+	Pass.Next = 0;
+
+	if (List->Status & L_RING)	// Rings are split by position
+		Pass.nSegments = LIST_SKIP;
+
+	else// Lists are split at the skip index's samples, with any data added at the front since it was built as a segment of their own
+	{
+		Pass.nSegments = 0;
+
+		if (List->Skip [0] != Front) Pass.Bounds [Pass.nSegments++] = Front;
+
+		for (index = 0; index < List->nSkip; ++index)
+			Pass.Bounds [Pass.nSegments++] = List->Skip [index];
+
+		Pass.Bounds [Pass.nSegments] = Front;
+	}
+
+	for (index = 0; index < (Dword) nThreads; ++index)	// Start workers, each with its own copy of context if asked
+	{
+		Workers [index].Pass = &Pass;
+		Workers [index].Context = Contexts != NULL ? Contexts + index * Pitch : Context;
+
+		if (Contexts != NULL) memcpy (Workers [index].Context, Context, SizeOfContext);
+
+		Workers [index].Started = index == 0 || ListThreadStart (&Workers [index].Thread, ListWorker, &Workers [index]);
+	}
+
+	ListWorker (&Workers [0]);	// Take part, then wait for the others
+
+	for (index = 1; index < (Dword) nThreads; ++index)
+		if (Workers [index].Started) ListThreadJoin (Workers [index].Thread);
+
+	if (Contexts != NULL)	// Fold copies of workers that ran into context, in order
+	{
+		for (index = 0; index < (Dword) nThreads; ++index)
+			if (Workers [index].Started && Reduce != NULL) Reduce (Context, Workers [index].Context);
+
+		MemFree (Contexts);
+	}
+}
+
+
+/********************************************************************
+*																	*
+*							ListStaticInit							*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to initialize a static linked list
+// Input:	Node count, and per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+ptLIST ListStaticInit (int nNodes, Dword SizeOfObject)
+{
+	ptLIST List;// New list
+	ptLISTNODE Node;// Node being bound to free list
+
+	Dword Stride = NODE_SIZE + LIST_ROUND(SizeOfObject);// Spacing of nodes in bank, keeping them aligned
+
+	int index;	// Loop variable
+
+	if (nNodes < 1)	// Ascertain that the list can hold a datum
+		return NULL;
+
+	List = (ptLIST) MemAlloc (sizeof(tLIST) + nNodes * Stride, MEM_ZERO);	// Allocate list and node bank together
+
+	if (List == NULL)	// Ascertain that MemAlloc succeeded
+		return NULL;
+
+	List->nMax = nNodes;// Set per-object size and node max fields in list
+	List->SizeOfObject = SizeOfObject;
+
+	List->Free = Node = (ptLISTNODE) &List [BASE_EXTENT];	// Refer free list to node bank
+
+	for (index = 1; index < nNodes; ++index)// Bind each node to the next in bank; the last ends the free list
+		Node = Node->Next = (ptLISTNODE)((Pbyte) Node + Stride);
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListDynamicInit							*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to initialize a dynamic linked list
+// Input:	Per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+ptLIST ListDynamicInit (Dword SizeOfObject)
+{
+	ptLIST List = (ptLIST) MemAlloc (sizeof(tLIST), MEM_ZERO);	// New list, without nodes or a reserve
+
+	if (List == NULL)	// Ascertain that MemAlloc succeeded
+		return NULL;
+
+	List->nMax = ~0;// Set max value and per-object size
+	List->SizeOfObject = SizeOfObject;
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListRefill								*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to refill a dynamic list's reserve of nodes with a batch carved together
+// Input:	Pointer to a list with an empty reserve
+// Return:	No return value; the reserve stays empty if memory ran out
+
+void ListRefill (ptLIST List)
+{
+	void * Nodes [LIST_BATCH];	// Batch of nodes
+
+	Dword nNodes = MemAllocBatch (LIST_BATCH, List->SizeOfObject + NODE_SIZE, Nodes, 0);	// Count of nodes allocated
+
+	while (nNodes != 0)	// Chain nodes onto reserve, last first, so the reserve runs in address order
+	{
+		ptLISTNODE Node = (ptLISTNODE) Nodes [--nNodes];// Refer to node
+
+		Node->Next = List->Free;
+		List->Free = Node;
+	}
+}
+
+
+/********************************************************************
+*																	*
+*							ListTakeNode							*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to take a node for a new datum
+// Input:	A list handle
+// Return:	Node, if successful; NULL if a static list is full or memory ran out
+
+ptLISTNODE ListTakeNode (ptLIST List)
+{
+	ptLISTNODE Node;// Node taken
+
+	if (List->Status & L_SLAB)	// If list draws nodes from a slab, take one
+		return (ptLISTNODE) MemSlabAlloc (List->Slab);
+
+	if ((List->Status & L_DYNAMIC) && List->Free == NULL)	// Refill an empty reserve
+		ListRefill (List);
+
+	Node = List->Free;	// Pop node from free list or reserve
+
+	if (Node != NULL) List->Free = Node->Next;
+
+	return Node;
+	// Return node
+}
+
+
+/********************************************************************
+*																	*
+*							ListLinkNode							*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to load a datum into a node and add it at the back of the list's ring
+// Input:	A list handle, node, and pointer to datum
+// Return:	No return value
+
+void ListLinkNode (ptLIST List, ptLISTNODE Node, void * Datum)
+{
+	if (List->nNodes++ == 0)// Handle list according to whether it is empty, and document addition of node
+	{
+		Node->Prev = Node->Next = Node;	// Bind node to itself
+
+		List->Head = Node;	// Assign list head
+	}
+
+	else
+	{
+		Node->Next = List->Head;// Update nodes' connections
+		Node->Prev = List->Head->Prev;
+		Node->Prev->Next = Node;
+		List->Head->Prev = Node;
+	}
+
+	memcpy (&Node [BASE_EXTENT], Datum, List->SizeOfObject);	// Copy datum into node's data section
+
+	if (List->Index != NULL)// Enter datum into index
+		ListIndexAdd (List, &Node [BASE_EXTENT]);
+}
+
+/********************************************************************
+*																	*
+*							ListTakeRun								*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to take a run of nodes for new data, allocating any the reserve lacks as one batch
+// Input:	A list handle, count of nodes, and array to load with them
+// Return:	A code indicating the results of the taking; on failure no node is taken
+
+RETCODE ListTakeRun (ptLIST List, Dword Count, void * Nodes [])
+{
+	ptLISTNODE Node;// Node being taken or handed back
+
+	Dword nTaken = 0;	// Count of nodes taken
+
+	if (List->Status & L_SLAB)	// If list draws nodes from a slab, take them one by one, handing them back if it runs dry
+	{
+		while (nTaken < Count && (Nodes [nTaken] = MemSlabAlloc (List->Slab)) != NULL)
+			++nTaken;
+
+		if (nTaken == Count)
+			return RETCODE_SUCCESS;
+
+		while (nTaken != 0) MemSlabFree (List->Slab, Nodes [--nTaken]);
+
+		return RETCODE_FAILURE;
+	}
+
+	for (Node = List->Free; Node != NULL && nTaken < Count; Node = Node->Next)	// Pop nodes from free list or reserve
+		Nodes [nTaken++] = Node;
+
+	List->Free = Node;
+
+	if (nTaken < Count && (List->Status & L_DYNAMIC))	// Allocate the shortfall as one batch
+		nTaken += MemAllocBatch (Count - nTaken, List->SizeOfObject + NODE_SIZE, Nodes + nTaken, 0);
+
+	if (nTaken == Count)
+		return RETCODE_SUCCESS;
+
+	while (nTaken != 0)	// A static list lacks room, or memory ran out; nodes taken go back, batch and all
+	{
+		Node = (ptLISTNODE) Nodes [--nTaken];
+
+		Node->Next = List->Free;
+		List->Free = Node;
+	}
+
+	return RETCODE_FAILURE;
+}
+
+
+/********************************************************************
+*																	*
+*							ListAddArray							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to add a run of data at either end of a list, keeping their order
+// Input:	A list handle, pointer to packed data, their count, and whether to add at the front
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+RETCODE ListAddArray (ptLIST List, Pbyte Data, Dword Count, BOOL Front)
+{
+	ptLISTNODE First = NULL, Last = NULL, Node;	// Ends of run, and node being loaded
+
+	void * Nodes [LIST_RUN];// Nodes of part of run
+
+	Dword nRun, index, next;// Count of nodes in part of run, and loop variables
+
+	if (Count == 0)	// Nothing to add
+		return RETCODE_SUCCESS;
+
+	if (List->Index != NULL && ListIndexReserve (List, Count) != RETCODE_SUCCESS)	// Make room in index first
+		return RETCODE_FAILURE;
+
+	if (List->Status & L_UNROLLED)	// Fill end chunks outward, walking data backward at the front so their order holds
+	{
+		for (index = 0; index < Count; ++index)
+		{
+			if (ListChunkAdd (List, Data + (Front ? Count - 1 - index : index) * List->SizeOfObject, Front) != RETCODE_SUCCESS)
+			{
+				while (index-- != 0) ListDelete (List, Front ? ListFront (List) : ListBack (List));	// Take back data added
+
+				return RETCODE_FAILURE;
+			}
+		}
+
+		return RETCODE_SUCCESS;
+	}
+
+	if (List->Status & L_RING)	// Grow ring to fit the run, then copy it into the slots past the chosen end
+	{
+		while (List->Capacity - List->nNodes < Count)
+			if (!(List->Status & L_DYNAMIC) || ListRingGrow (List) != RETCODE_SUCCESS) return RETCODE_FAILURE;
+
+		if (Front) List->First = List->First >= Count ? List->First - Count : List->First + List->Capacity - Count;
+
+		for (index = 0; index < Count; ++index)
+			memcpy (ListRingSlot (List, (Front ? 0 : List->nNodes) + index), Data + index * List->SizeOfObject, List->SizeOfObject);
+
+		List->nNodes += Count;	// Document addition of data
+
+		return RETCODE_SUCCESS;
+	}
+
+	if (Count > (Dword) (List->nMax - List->nNodes))	// Ascertain that a static list has room
+		return RETCODE_FAILURE;
+
+	for (index = 0; index < Count; index += nRun)	// Take and load the run in parts, each while its nodes are still in cache
+	{
+		nRun = Count - index < LIST_RUN ? Count - index : LIST_RUN;
+
+		if (ListTakeRun (List, nRun, Nodes) != RETCODE_SUCCESS)	// Memory ran out; hand back the nodes loaded so far
+		{
+			for (Node = First; index-- != 0; Node = First)
+			{
+				First = Node->Next;
+
+				if (List->Index != NULL) ListIndexRemove (List, &Node [BASE_EXTENT]);
+
+				if (List->Status & L_SLAB) MemSlabFree (List->Slab, Node);
+
+				else// Return node to reserve
+				{
+					Node->Next = List->Free;
+					List->Free = Node;
+				}
+			}
+
+			return RETCODE_FAILURE;
+		}
+
+		for (next = 0; next < nRun; ++next)	// Load data, binding each node after the one before
+		{
+			Node = (ptLISTNODE) Nodes [next];
+
+			memcpy (&Node [BASE_EXTENT], Data + (index + next) * List->SizeOfObject, List->SizeOfObject);
+
+			if (List->Index != NULL) ListIndexAdd (List, &Node [BASE_EXTENT]);
+
+			if (Last != NULL) Last->Next = Node;
+
+			else First = Node;
+
+			Node->Prev = Last;
+			Last = Node;
+		}
+	}
+
+	if (List->nNodes == 0)	// Close run into a ring of its own
+	{
+		First->Prev = Last;
+		Last->Next = First;
+
+		List->Head = First;
+	}
+
+	else// Splice run in at back of ring, between the back node and head
+	{
+		First->Prev = List->Head->Prev;
+		First->Prev->Next = First;
+		Last->Next = List->Head;
+		List->Head->Prev = Last;
+
+		if (Front) List->Head = First;	// Then make it the head
+	}
+
+	List->nNodes += Count;	// Document addition of data
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListUnrolledInit						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to initialize an unrolled linked list
+// Input:	Per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+ptLIST ListUnrolledInit (Dword SizeOfObject)
+{
+	ptLIST List = ListDynamicInit (SizeOfObject);	// New list, without chunks
+
+	Dword Bytes = sizeof(void *);	// Size of chunks
+
+	if (List == NULL)	// Ascertain that ListDynamicInit succeeded
+		return NULL;
+
+	List->Stride = SizeOfObject != 0 ? LIST_ROUND(SizeOfObject) : sizeof(void *);	// Slots stay aligned and distinct
+
+	List->nSlots = (CHUNK_BYTES - sizeof(tLISTCHUNK)) / List->Stride;	// Fill the target span, within the occupancy map
+
+	if (List->nSlots > CHUNK_SLOTS) List->nSlots = CHUNK_SLOTS;
+
+	if (List->nSlots < 1) List->nSlots = 1;
+
+	while (Bytes < sizeof(tLISTCHUNK) + List->nSlots * List->Stride)	// Round chunks up to a power of two, so data find their chunk by masking
+		Bytes <<= 1;
+
+	List->ChunkBytes = Bytes;
+
+	List->nSlots = (Bytes - sizeof(tLISTCHUNK)) / List->Stride;	// Spend any rounding on further slots
+
+	if (List->nSlots > CHUNK_SLOTS) List->nSlots = CHUNK_SLOTS;
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListChunkAdd							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to add a datum at either end of an unrolled list, opening a chunk if the end one is full
+// Input:	A list handle, pointer to datum, and whether to add at the front
+// Return:	A code indicating the results of the addition
+
+RETCODE ListChunkAdd (ptLIST List, void * Datum, BOOL Front)
+{
+	ptLISTCHUNK Chunk = List->Chunks;	// Chunk at the end taking datum
+
+	int Slot = -1;	// Slot taking datum
+
+	if (Chunk != NULL)	// Look for room past the end chunk's outermost datum
+	{
+		if (Front) Slot = ListLowBit(Chunk->Used) - 1;
+
+		else if ((Slot = ListHighBit((Chunk = Chunk->Prev)->Used) + 1) == (int) List->nSlots) Slot = -1;
+	}
+
+	if (Slot < 0)	// Open a chunk beyond the end, filling it from the far side inward
+	{
+		if ((Chunk = List->Spare) != NULL) List->Spare = NULL;
+
+		else if ((Chunk = (ptLISTCHUNK) MemAllocAligned (List->ChunkBytes, List->ChunkBytes, 0)) == NULL)
+			return RETCODE_FAILURE;
+
+		Chunk->Used = 0;
+
+		if (List->Chunks == NULL)	// Bind chunk to itself
+		{
+			Chunk->Prev = Chunk->Next = Chunk;
+
+			List->Chunks = Chunk;
+		}
+
+		else// Link chunk in before front chunk, which is after back chunk
+		{
+			Chunk->Next = List->Chunks;
+			Chunk->Prev = List->Chunks->Prev;
+			Chunk->Prev->Next = Chunk;
+			List->Chunks->Prev = Chunk;
+		}
+
+		if (Front) List->Chunks = Chunk;
+
+		Slot = Front ? List->nSlots - 1 : 0;
+	}
+
+	Chunk->Used |= (Dword) 1 << Slot;	// Occupy slot, and document addition of datum
+
+	++List->nNodes;
+
+	memcpy (LIST_SLOT(List, Chunk, Slot), Datum, List->SizeOfObject);	// Copy datum into slot
+
+	if (List->Index != NULL)// Enter datum into index
+		ListIndexAdd (List, LIST_SLOT(List, Chunk, Slot));
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListChunkDrop							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to unlink an emptied chunk from an unrolled list, keeping it as the spare or releasing it
+// Input:	A list handle, and empty chunk
+// Return:	No return value
+
+void ListChunkDrop (ptLIST List, ptLISTCHUNK Chunk)
+{
+	if (Chunk->Next == Chunk) List->Chunks = NULL;	// Unlink chunk, reassigning the front if need be
+
+	else if (List->Chunks == Chunk) List->Chunks = Chunk->Next;
+
+	if (List->nSkip != 0) ListSkipDrop (List, Chunk, Chunk->Next);	// Chunk may be sampled by the skip index
+
+	Chunk->Prev->Next = Chunk->Next;
+	Chunk->Next->Prev = Chunk->Prev;
+
+	if (List->Spare == NULL) List->Spare = Chunk;	// Keep one chunk, so a datum pushed and popped at a boundary does not churn the pool
+
+	else MemFree (Chunk);
+}
+
+
+/********************************************************************
+*																	*
+*							ListRingInit							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to initialize a ring list
+// Input:	Capacity, which a dynamic list takes as a hint, per-element datum size, and whether the ring may grow
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+ptLIST ListRingInit (int nNodes, Dword SizeOfObject, BOOL Dynamic)
+{
+	ptLIST List;// New list
+
+	Dword Stride = SizeOfObject != 0 ? LIST_ROUND(SizeOfObject) : sizeof(void *);	// Slots stay aligned and distinct
+
+	if (Dynamic)// Start a growable ring at the hinted capacity, if any
+	{
+		if ((List = ListDynamicInit (SizeOfObject)) == NULL)
+			return NULL;
+
+		if (nNodes > 0 && (List->Ring = (Pbyte) MemAlloc (nNodes * Stride, 0)) != NULL)
+			List->Capacity = nNodes;
+	}
+
+	else// Allocate list and ring together, as for static lists
+	{
+		if (nNodes < 1)	// Ascertain that the list can hold a datum
+			return NULL;
+
+		if ((List = (ptLIST) MemAlloc (sizeof(tLIST) + nNodes * Stride, MEM_ZERO)) == NULL)
+			return NULL;
+
+		List->nMax = List->Capacity = nNodes;
+		List->SizeOfObject = SizeOfObject;
+
+		List->Ring = (Pbyte) &List [BASE_EXTENT];
+	}
+
+	List->Stride = Stride;
+
+	return List;
+	// Return new list
+}
+
+
+/********************************************************************
+*																	*
+*							ListRingGrow							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to double a dynamic ring list's capacity, unwrapping its data to the start of the new ring
+// Input:	A list handle
+// Return:	A code indicating the results of the growth
+
+RETCODE ListRingGrow (ptLIST List)
+{
+	Dword Capacity = List->Capacity >= RING_MIN / 2 ? List->Capacity * 2 : RING_MIN;	// Capacity of new ring
+
+	Dword Run = List->Capacity - List->First;	// Data before the old ring wraps
+
+	Pbyte Ring = (Pbyte) MemAlloc (Capacity * List->Stride, 0);	// New ring
+
+	if (Ring == NULL)	// Ascertain that MemAlloc succeeded
+		return RETCODE_FAILURE;
+
+	if (Run > (Dword) List->nNodes) Run = List->nNodes;
+
+	if (List->Ring != NULL)	// Copy data in two runs, front first, then release old ring
+	{
+		memcpy (Ring, List->Ring + List->First * List->Stride, Run * List->Stride);
+		memcpy (Ring + Run * List->Stride, List->Ring, (List->nNodes - Run) * List->Stride);
+
+		MemFree (List->Ring);
+	}
+
+	List->Ring = Ring;
+	List->Capacity = Capacity;
+	List->First = 0;
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListRingRemove							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to remove a datum from a ring list, closing the gap from whichever side is shorter
+// Input:	A list handle, and position of datum from the front
+// Return:	No return value
+
+void ListRingRemove (ptLIST List, Dword Pos)
+{
+	if (Pos < (Dword) List->nNodes / 2)	// Shift data before the gap back by one, then advance the front
+	{
+		for (; Pos != 0; --Pos)
+			memcpy (ListRingSlot (List, Pos), ListRingSlot (List, Pos - 1), List->SizeOfObject);
+
+		if (++List->First == List->Capacity) List->First = 0;
+	}
+
+	else for (; Pos + 1 < (Dword) List->nNodes; ++Pos)	// Shift data after the gap forward by one
+		memcpy (ListRingSlot (List, Pos), ListRingSlot (List, Pos + 1), List->SizeOfObject);
+
+	--List->nNodes;	// Document removal of datum
+}
+
+
+/********************************************************************
+*																	*
+*							ListIndexReserve						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to make room in a list's index for further data, rebuilding it larger if need be
+// Input:	A list handle, and count of data about to be added
+// Return:	A code indicating the results of the reservation
+
+RETCODE ListIndexReserve (ptLIST List, Dword Count)
+{
+	ptLISTENTRY Index;	// Rebuilt index
+
+	Dword Size = List->IndexSize != 0 ? List->IndexSize : INDEX_MIN, Shift = 32, Slot, index;	// Size and shift of rebuilt index; loop variables
+
+	while ((List->nNodes + Count) * 2 > Size)	// Keep at most half of the slots in use
+		Size <<= 1;
+
+	if (Size == List->IndexSize)// Index already has room
+		return RETCODE_SUCCESS;
+
+	if ((Index = (ptLISTENTRY) MemAlloc (Size * sizeof(tLISTENTRY), MEM_ZERO)) == NULL)
+		return RETCODE_FAILURE;
+
+	for (Slot = Size; Slot > 1; Slot >>= 1)	// Shift mixed hashes down to the index's bits
+		--Shift;
+
+	List->IndexShift = Shift;
+
+	for (index = 0; index < List->IndexSize; ++index)	// Carry entries over, by the hashes they keep
+	{
+		if (List->Index [index].Datum == NULL) continue;
+
+		for (Slot = LIST_BUCKET(List, List->Index [index].Hash); Index [Slot].Datum != NULL; Slot = (Slot + 1) & (Size - 1));
+
+		Index [Slot] = List->Index [index];
+	}
+
+	if (List->Index != NULL) MemFree (List->Index);
+
+	List->Index = Index;
+	List->IndexSize = Size;
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListIndexAdd							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to enter a datum into a list's index, which must have room
+// Input:	A list handle, and datum in list
+// Return:	No return value
+
+void ListIndexAdd (ptLIST List, void * Datum)
+{
+	Dword Hash = List->Hash (List->Key (Datum)), Slot;	// Hash of datum's key, and index slot being probed
+
+	for (Slot = LIST_BUCKET(List, Hash); List->Index [Slot].Datum != NULL; Slot = (Slot + 1) & (List->IndexSize - 1));
+
+	List->Index [Slot].Datum = Datum;
+	List->Index [Slot].Hash = Hash;
+}
+
+
+/********************************************************************
+*																	*
+*							ListIndexRemove							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to take a datum out of a list's index, pulling later entries of its probe run back
+// Input:	A list handle, and datum in list
+// Return:	No return value
+
+void ListIndexRemove (ptLIST List, void * Datum)
+{
+	Dword Mask = List->IndexSize - 1, Hash = List->Hash (List->Key (Datum)), Slot, Next;	// Index mask, hash of datum's key, and slots being probed
+
+	for (Slot = LIST_BUCKET(List, Hash); List->Index [Slot].Datum != Datum; Slot = (Slot + 1) & Mask)
+		if (List->Index [Slot].Datum == NULL) return;	// Datum was never entered
+
+	for (Next = (Slot + 1) & Mask; List->Index [Next].Datum != NULL; Next = (Next + 1) & Mask)	// Fill the hole with any later entry whose probe passed it
+	{
+		Dword Home = LIST_BUCKET(List, List->Index [Next].Hash);// Slot the entry's probe began at
+
+		if (((Next - Home) & Mask) >= ((Next - Slot) & Mask))
+		{
+			List->Index [Slot] = List->Index [Next];
+
+			Slot = Next;
+		}
+	}
+
+	List->Index [Slot].Datum = NULL;
+}
+
+
+/********************************************************************
+*																	*
+*							ListSkipBuild							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to rebuild a list's skip index, sampling nodes or chunks at even spacing along it
+// Input:	A list handle
+// Return:	A code indicating the results of the rebuild
+
+RETCODE ListSkipBuild (ptLIST List)
+{
+	Dword Count = 0, Span, index;	// Count of nodes or chunks, spacing of samples, and loop variable
+
+	if (List->Skip == NULL && (List->Skip = (void **) MemAlloc (LIST_SKIP * sizeof(void *), 0)) == NULL)
+		return RETCODE_FAILURE;
+
+	List->nSkip = 0;
+
+	if (List->Status & L_UNROLLED)	// Count chunks, then sample them
+	{
+		ptLISTCHUNK Chunk = List->Chunks;	// Chunk being visited
+
+		do ++Count; while ((Chunk = Chunk->Next) != List->Chunks);
+
+		Span = (Count + LIST_SKIP - 1) / LIST_SKIP;
+
+		for (index = 0; index < Count; ++index, Chunk = Chunk->Next)
+			if (index % Span == 0) List->Skip [List->nSkip++] = Chunk;
+	}
+
+	else// Sample nodes
+	{
+		ptLISTNODE Node = List->Head;	// Node being visited
+
+		Count = List->nNodes;
+
+		Span = (Count + LIST_SKIP - 1) / LIST_SKIP;
+
+		for (index = 0; index < Count; ++index, Node = Node->Next)
+			if (index % Span == 0) List->Skip [List->nSkip++] = Node;
+	}
+
+	List->SkipBase = List->nNodes;
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+
+/********************************************************************
+*																	*
+*							ListSkipDrop							*
+*																	*
+********************************************************************/
+
+
+
+// Purpose:	Used to keep a list's skip index valid as a node or chunk leaves, moving its sample onto the successor
+// Input:	A list handle, departing node or chunk, already out of the front, and its successor
+// Return:	No return value
+
+void ListSkipDrop (ptLIST List, void * Item, void * Next)
+{
+	void * Front = List->Status & L_UNROLLED ? (void *) List->Chunks : (void *) List->Head;	// Front of list, once item is gone
+
+	Dword index;// Loop variable
+
+	if (Front == NULL)	// Skip index samples nothing now
+	{
+		List->nSkip = 0;
+
+		return;
+	}
+
+	for (index = 0; index < List->nSkip; ++index)	// Find item among the samples
+		if (List->Skip [index] == Item) break;
+
+	if (index == List->nSkip)	// Item was not sampled
+		return;
+
+	if (Next != (index + 1 < List->nSkip ? List->Skip [index + 1] : Front))	// Sample the successor instead
+		List->Skip [index] = Next;
+
+	else// Successor bounds a segment already, so the item's segment closes up
+	{
+		--List->nSkip;
+
+		memmove (&List->Skip [index], &List->Skip [index + 1], (List->nSkip - index) * sizeof(void *));
+	}
+}
+
+
+/********************************************************************
+*																	*
+*							ListRunSegment							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to perform a pass's operation on one segment of its list
+// Input:	A pass, segment index, and context to pass to routine
+// Return:	No return value
+
+void ListRunSegment (ptLISTPASS Pass, Dword Segment, void * Context)
+{
+	ptLIST List = Pass->List;	// List being processed
+
+	if (List->Status & L_RING)	// Visit segment's share of positions, spreading any remainder over the first segments
+	{
+		Dword Share = List->nNodes / Pass->nSegments, Extra = List->nNodes % Pass->nSegments;	// Positions per segment, and remainder
+
+		Dword Pos = Segment * Share + (Segment < Extra ? Segment : Extra), End = Pos + Share + (Segment < Extra);	// Bounds of segment
+
+		for (; Pos < End; ++Pos)
+			Pass->Callback (ListRingSlot (List, Pos), Context);
+	}
+
+	else if (List->Status & L_UNROLLED)	// Visit segment's chunks
+	{
+		ptLISTCHUNK Chunk = (ptLISTCHUNK) Pass->Bounds [Segment];	// Chunk being processed
+
+		do {
+			ListSweepChunk (List, Chunk, Pass->Callback, Context);
+
+			Chunk = Chunk->Next;
+		} while (Chunk != Pass->Bounds [Segment + 1]);
+	}
+
+	else// Visit segment's nodes
+	{
+		ptLISTNODE Node = (ptLISTNODE) Pass->Bounds [Segment];	// Node being processed
+
+		do {
+			Pass->Callback (&Node [BASE_EXTENT], Context);
+
+			Node = Node->Next;
+		} while (Node != Pass->Bounds [Segment + 1]);
+	}
+}
+
+
+/********************************************************************
+*																	*
+*							ListWorker								*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Used to claim and run a pass's segments until none are left
+// Input:	A worker
+// Return:	No meaningful value
+
+LIST_WORKER ListWorker (void * Param)
+{
+	ptLISTWORKER Worker = (ptLISTWORKER) Param;	// Worker running
+
+	Dword Segment;	// Segment claimed
+
+	while ((Segment = (Dword) ListClaim (&Worker->Pass->Next)) < Worker->Pass->nSegments)
+		ListRunSegment (Worker->Pass, Segment, Worker->Context);
+
+	return LIST_WORKER_DONE;
+}
+
+
+#else // LIST_PORTABLE
+
 /********************************************************************
 *																	*
 *							ListCreate								*
@@ -20,16 +1889,45 @@ QUICK ptLIST ListCreate (int nNodes, Dword SizeOfObject, FLAGS Settings)
 {
 	_asm {
 		mov eax, [esp+12];	/* Load settings */
-		mov ecx, [esp+4];	/* Load arguments */
+		test eax, LIST_PORTABLE_SETTINGS;	/* The naked path rejects settings it lacks */
+		jz $cLoad;
+		xor eax, eax;	/* Load failure return value */
+		ret;/* Return to caller */
+$cLoad:	mov ecx, [esp+4];	/* Load arguments */
 		mov edx, [esp+8];
-		push eax;	/* Save settings */
+		test eax, L_SLAB;	/* Slab lists are dynamic */
+		jz $cKind;
+		or eax, L_DYNAMIC;
+$cKind:	push eax;	/* Save settings */
 		test eax, L_DYNAMIC;	/* Check what type of list to load */
 		jz $cStat;
 		call ListDynamicInit;	/* Dynamic initialization */
 		jmp $cDone;
 $cStat:	call ListStaticInit;/* Static initialization */
-$cDone:	pop dword ptr [eax]._Status;/* Load list status */
+$cDone:	pop ecx;/* Restore settings */
+		test eax, eax;	/* Ascertain that initialization succeeded */
+		jz $cRet;
+		mov [eax]._Status, ecx;	/* Load list status */
+		test [eax]._Status, L_SLAB;	/* If list draws nodes from a slab, create it */
+		jz $cRet;
+		push eax;	/* Save list */
+		mov ecx, [eax]._SizeOfObject;	/* Load arguments */
+		push 0;
+		add ecx, NODE_SIZE;
+		push ecx;
+		call MemSlabCreate;	/* Create slab of nodes */
+		add esp, 8;	/* Remove arguments from stack */
+		pop edx;/* Restore list */
+		test eax, eax;	/* Ascertain that MemSlabCreate succeeded */
+		jnz $cSlab;
+		push edx;	/* Otherwise free list memory */
+		call MemFree;
+		add esp, 4;	/* Remove argument from stack */
+		xor eax, eax;	/* Load failure return value */
 		ret;/* Return to caller */
+$cSlab:	mov [edx]._Slab, eax;	/* Attach slab to list */
+		mov eax, edx;	/* Load list as return value */
+$cRet:	ret;/* Return to caller */
 	}
 }
 
@@ -47,8 +1945,15 @@ QUICK RETCODE ListDestroy (tLIST * List)
 {
 	_asm {
 		push [esp+4];/* Load argument onto stack */
-		call ListFlush;	/* Empty list */
-		call MemFree;	/* Free list memory; keep argument on stack */
+		mov eax, [esp];	/* If list draws nodes from a slab, release them all at once */
+		test [eax]._Status, L_SLAB;
+		jz $dFlush;
+		push [eax]._Slab;
+		call MemSlabDestroy;
+		add esp, 4;	/* Remove argument from stack */
+		jmp $dFree;
+$dFlush:call ListFlush;	/* Empty list */
+$dFree:	call MemFree;	/* Free list memory; keep argument on stack */
 		add esp, 4;	/* Restore stack */
 		mov eax, RETCODE_SUCCESS;	/* Load success return value */
 		ret;/* Return to caller */
@@ -132,7 +2037,7 @@ QUICK void * ListNext (tLIST * List, void * Datum)
 	_asm {
 		mov ebx, [esp+8];	/* Load node before datum */
 		sub ebx, NODE_SIZE;
-		mov ebx, [ebx]._Prev;	/* Load next node */
+		mov ebx, [ebx]._Next;	/* Load next node */
 		lea eax, [ebx]._DATA;	/* Load node data as return value */
 		ret;/* Return to caller */
 	}
@@ -154,15 +2059,26 @@ QUICK RETCODE ListToFront (tLIST * List, void * Datum)
 		mov ebx, [esp+4];	/* Load list */
 		test [ebx]._Status, L_DYNAMIC;	/* If list is dynamic, allocate a node */
 		jz $lStat;
+		test [ebx]._Status, L_SLAB;	/* If list draws nodes from a slab, take one */
+		jz $lHeap;
 		push ebx;	/* Save list */
-		mov ecx, [ebx]._SizeOfObject;	/* Load arguments */
-		push 0;
-		add ecx, NODE_SIZE;
-		push ecx;
-		call MemAlloc;	/* Allocate node */
-		add esp, 8;	/* Remove arguments from stack */
+		push [ebx]._Slab;	/* Load argument */
+		call MemSlabAlloc;	/* Allocate node */
+		add esp, 4;	/* Remove argument from stack */
 		pop ebx;/* Restore list */
-		mov [ebx]._Free, eax; /* Set allocated node on free list */
+		test eax, eax;	/* Ascertain that MemSlabAlloc succeeded */
+		jnz $lSlab;
+		mov eax, RETCODE_FAILURE;	/* Load failure return value */
+		ret;/* Return to caller */
+$lSlab:	mov [ebx]._Free, eax; /* Set allocated node on free list */
+		jmp $lStat;
+$lHeap:	cmp dword ptr [ebx]._Free, 0;	/* Other dynamic lists take nodes from a reserve; refill it when empty */
+		jne $lStat;
+		call ListRefill;
+		cmp dword ptr [ebx]._Free, 0;	/* Ascertain that the refill succeeded */
+		jne $lStat;
+		mov eax, RETCODE_FAILURE;	/* Load failure return value */
+		ret;/* Return to caller */
 $lStat:	mov eax, [ebx]._Free;	/* Refer to first node in free list */
 		mov edx, [eax]._Next;	/* Reassign free list head */
 		mov [ebx]._Free, edx;
@@ -211,15 +2127,26 @@ QUICK RETCODE ListToBack (tLIST * List, void * Datum)
 		mov ebx, [esp+4];/* Load list */
 		test [ebx]._Status, L_DYNAMIC;	/* If list is dynamic, allocate a node */
 		jz $lStat;
+		test [ebx]._Status, L_SLAB;	/* If list draws nodes from a slab, take one */
+		jz $lHeap;
 		push ebx;	/* Save list */
-		mov ecx, [ebx]._SizeOfObject;	/* Load arguments */
-		push 0;
-		add ecx, NODE_SIZE;
-		push ecx;
-		call MemAlloc;	/* Allocate node */
-		add esp, 8;	/* Remove arguments from stack */
+		push [ebx]._Slab;	/* Load argument */
+		call MemSlabAlloc;	/* Allocate node */
+		add esp, 4;	/* Remove argument from stack */
 		pop ebx;/* Restore list */
-		mov [ebx]._Free, eax; /* Set allocated node on free list */
+		test eax, eax;	/* Ascertain that MemSlabAlloc succeeded */
+		jnz $lSlab;
+		mov eax, RETCODE_FAILURE;	/* Load failure return value */
+		ret;/* Return to caller */
+$lSlab:	mov [ebx]._Free, eax; /* Set allocated node on free list */
+		jmp $lStat;
+$lHeap:	cmp dword ptr [ebx]._Free, 0;	/* Other dynamic lists take nodes from a reserve; refill it when empty */
+		jne $lStat;
+		call ListRefill;
+		cmp dword ptr [ebx]._Free, 0;	/* Ascertain that the refill succeeded */
+		jne $lStat;
+		mov eax, RETCODE_FAILURE;	/* Load failure return value */
+		ret;/* Return to caller */
 $lStat:	mov eax, [ebx]._Free;	/* Refer to first node in free list */
 		mov edx, [eax]._Next;	/* Reassign free list head */
 		mov [ebx]._Free, edx;
@@ -283,9 +2210,15 @@ $Inner:	mov [ecx]._Next, edx;	/* Update nodes' connections */
 		mov [eax]._Free, ebx;
 		ret;/* Return to caller */
 $Dynam:	push ebx;	/* Load argument */
+		test [eax]._Status, L_SLAB;	/* If list draws nodes from a slab, return node there */
+		jnz $eSlab;
 		call MemFree;	/* Release node memory */
 		add esp, 4;	/* Remove argument from stack */
 		ret;/* Return to caller */
+$eSlab:	push [eax]._Slab;	/* Load argument */
+		call MemSlabFree;	/* Release node to slab */
+		add esp, 8;	/* Remove arguments from stack */
+		ret;/* Return to caller */
 	}
 }
 
@@ -303,6 +2236,10 @@ QUICK void ListFlush (tLIST * List)
 {
 	_asm {
 		mov eax, [esp+4];	/* Load list */
+		mov ecx, [eax]._Status;	/* Dynamic lists with a reserve release it too, so process them apart */
+		and ecx, L_DYNAMIC + L_SLAB;
+		cmp ecx, L_DYNAMIC;
+		je $Batch;
 		cmp dword ptr [eax]._nNodes, 0;	/* If list is empty, return trivially */
 		jne $Flush;
 		ret;/* Return to caller */
@@ -319,15 +2256,47 @@ $Full:	mov [eax]._Free, ebx;	/* Reassign free list and document flush */
 		mov dword ptr [eax]._nNodes, 0;
 		ret;/* Return to caller */
 $Purge:	push ebp;	/* Save ebp */
-		mov ebp, [eax]._Head;	/* Load list head */
-$Loop:	push eax;	/* Save pointer to list */
-		push ebp;	/* Load argument */
+		mov ebp, [eax]._Head;	/* Load list head; the list draws nodes from a slab, so return nodes there */
+$sLoop:	push eax;	/* Save pointer to list */
+		push ebp;	/* Load arguments */
+		push [eax]._Slab;
 		mov ebp, [ebp]._Next;	/* Move to next element in list */
-		call MemFree;	/* Delete the head */
-		add esp, 4;	/* Remove argument from stack */
+		call MemSlabFree;	/* Release the head to the slab */
+		add esp, 8;	/* Remove arguments from stack */
 		pop eax;
 		dec dword ptr [eax]._nNodes;/* Update node count, and quit if zero */
-		jnz $Loop;
+		jnz $sLoop;
+		pop ebp;/* Restore ebp */
+		ret;/* Return to caller */
+$Batch:	cmp dword ptr [eax]._nNodes, 0;	/* Splice any nodes onto the reserve */
+		je $bFree;
+		mov ebx, [eax]._Head;	/* Load list head */
+		mov ecx, [ebx]._Prev;	/* Bind final node to reserve */
+		mov edx, [eax]._Free;
+		mov [ecx]._Next, edx;
+		mov [eax]._Free, ebx;
+		mov dword ptr [eax]._nNodes, 0;	/* Document flush */
+$bFree:	push ebp;	/* Save ebp */
+		mov ebp, [eax]._Free;	/* Load reserve, and document its release */
+		mov dword ptr [eax]._Free, 0;
+		sub esp, LIST_BATCH * 4;/* Make room for a batch of nodes */
+$bLoop:	xor ecx, ecx;	/* Gather a batch of nodes */
+$bLoad:	test ebp, ebp;	/* Quit gathering at end of reserve */
+		jz $bSend;
+		mov [esp+ecx*4], ebp;	/* Add node to batch */
+		mov ebp, [ebp]._Next;	/* Move to next node in reserve */
+		inc ecx;/* Quit gathering once batch is full */
+		cmp ecx, LIST_BATCH;
+		jb $bLoad;
+$bSend:	test ecx, ecx;	/* Quit once no nodes remain */
+		jz $bDone;
+		mov eax, esp;	/* Load arguments */
+		push ecx;
+		push eax;
+		call MemFreeBatch;	/* Release the batch, merging neighbouring nodes */
+		add esp, 8;	/* Remove arguments from stack */
+		jmp $bLoop;	/* Iterate again */
+$bDone:	add esp, LIST_BATCH * 4;/* Remove batch room from stack */
 		pop ebp;/* Restore ebp */
 		ret;/* Return to caller */
 	}
@@ -528,7 +2497,208 @@ QUICK ptLIST ListDynamicInit (void)
 		add esp, 8;	/* Remove arguments from stack */
 		mov dword ptr [eax]._nNodes, 0;	/* Zero out node counter */
 		mov dword ptr [eax]._nMax, not 0;	/* Set max value */
+		mov dword ptr [eax]._Free, 0;	/* Start without a reserve of nodes */
 		pop [eax].SizeOfObject;	/* Set per-object size */
 		ret;/* Return to caller */
 	}
-}
\ No newline at end of file
+}
+
+/********************************************************************
+*																	*
+*							ListRefill								*
+*																	*
+********************************************************************/
+
+// Purpose:	Used to refill a dynamic list's reserve of nodes with a batch carved together
+// Input:	EBX : Pointer to a list with an empty reserve
+// Return:	No return value; the reserve stays empty if memory ran out
+
+QUICK void ListRefill (void)
+{
+	_asm {
+		sub esp, LIST_BATCH * 4;/* Make room for a batch of nodes */
+		mov eax, esp;	/* Load arguments */
+		mov ecx, [ebx]._SizeOfObject;
+		push 0;
+		push eax;
+		add ecx, NODE_SIZE;
+		push ecx;
+		push LIST_BATCH;
+		call MemAllocBatch;	/* Allocate nodes */
+		add esp, 16;/* Remove arguments from stack */
+		xor edx, edx;	/* Chain nodes onto reserve, last first, so the reserve runs in address order */
+$rLoop:	test eax, eax;	/* Quit once every node is chained */
+		jz $rDone;
+		dec eax;/* Bind node to reserve */
+		mov ecx, [esp+eax*4];
+		mov [ecx]._Next, edx;
+		mov edx, ecx;
+		jmp $rLoop;	/* Iterate again */
+$rDone:	mov [ebx]._Free, edx;	/* Assign reserve */
+		add esp, LIST_BATCH * 4;/* Remove batch room from stack */
+		ret;/* Return to caller */
+	}
+}
+
+/********************************************************************
+*																	*
+*							ListCreateIndexed						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Creates a list object keeping a hash index of its data by key
+// Input:	A node count, per-element size, list settings, and routines yielding a datum's key and hashing a key
+// Return:	NULL; the naked path keeps no index
+
+ptLIST ListCreateIndexed (int nNodes, Dword SizeOfObject, FLAGS Settings, KEYOF Key, HASH Hash)
+{
+	return NULL;
+	// Return failure
+}
+
+/********************************************************************
+*																	*
+*							ListSearchKey							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Searches a list for a datum with a given key
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	Pointer to the datum if it exists; NULL otherwise
+
+void * ListSearchKey (ptLIST List, EQUIVAL Callback, void * Key)
+{
+	return ListSearch (List, Callback, Key);
+	// Lists without an index are searched in order
+}
+
+/********************************************************************
+*																	*
+*							ListDeleteKey							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Deletes an entry with a given key from list
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	A code indicating whether an entry was deleted
+
+RETCODE ListDeleteKey (ptLIST List, EQUIVAL Callback, void * Key)
+{
+	void * Datum = ListSearch (List, Callback, Key);// Datum to delete
+
+	if (Datum == NULL)	// Ascertain that an entry has the key
+		return RETCODE_FAILURE;
+
+	ListDelete (List, Datum);
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************
+*																	*
+*							ListPrependArray						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Adds a run of entries to the front of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+RETCODE ListPrependArray (ptLIST List, void * Data, Dword Count)
+{
+	Dword index;// Loop variable
+
+	for (index = Count; index != 0; --index)// Add data last first, so their order holds
+	{
+		if (ListToFront (List, (Pbyte) Data + (index - 1) * List->SizeOfObject) != RETCODE_SUCCESS)
+		{
+			for (; index < Count; ++index) ListDelete (List, ListFront (List));	// Take back data added
+
+			return RETCODE_FAILURE;
+		}
+	}
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************
+*																	*
+*							ListAppendArray							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Adds a run of entries to the back of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+RETCODE ListAppendArray (ptLIST List, void * Data, Dword Count)
+{
+	Dword index;// Loop variable
+
+	for (index = 0; index < Count; ++index)
+	{
+		if (ListToBack (List, (Pbyte) Data + index * List->SizeOfObject) != RETCODE_SUCCESS)
+		{
+			while (index-- != 0) ListDelete (List, ListBack (List));// Take back data added
+
+			return RETCODE_FAILURE;
+		}
+	}
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************
+*																	*
+*							ListDeleteIf							*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Deletes every entry a routine picks out from list
+// Input:	A list handle, a routine returning nonzero for data to delete, and context to pass to routine
+// Return:	Count of entries deleted
+
+int ListDeleteIf (ptLIST List, EQUIVAL Callback, void * Context)
+{
+	void * Datum = ListFront (List), * Next;// Datum being tested, and its successor
+
+	int nNodes = ListNodeCount (List), index;	// Count of data before deletion, and loop variable
+
+	for (index = 0; index < nNodes; ++index, Datum = Next)
+	{
+		Next = ListNext (List, Datum);
+
+		if (Callback (Datum, Context)) ListDelete (List, Datum);
+	}
+
+	return nNodes - ListNodeCount (List);
+	// Return count of entries deleted
+}
+
+/********************************************************************
+*																	*
+*							ListExecuteParallel						*
+*																	*
+********************************************************************/
+
+
+// Purpose:	Performs an operation on all list elements
+// Input:	A list handle, an operation to execute, context to pass to routine, size of context, a routine folding
+//			a thread's copy of context into it, and count of threads
+// Return:	No value is returned; the naked path runs through the list on the calling thread
+
+void ListExecuteParallel (ptLIST List, EXECUTE Callback, void * Context, Dword SizeOfContext, REDUCE Reduce, int nThreads)
+{
+	ListExecute (List, Callback, Context);
+}
+
+#endif // LIST_PORTABLE
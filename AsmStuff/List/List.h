@@ -7,7 +7,7 @@
 *																	*
 ********************************************************************/
 
-#include "..\common.h"
+#include "../common.h"
 
 /********************************************************************
 *																	*
@@ -16,6 +16,9 @@
 ********************************************************************/
 
 #define L_DYNAMIC	0x1	// Dynamic list
+#define L_SLAB		0x2	// Dynamic list drawing its nodes from a private slab; implies L_DYNAMIC
+#define L_UNROLLED	0x4	// Dynamic list storing its data side by side in chunks; implies L_DYNAMIC, excludes L_SLAB; requires the portable backend
+#define L_RING		0x8	// List storing its data in a ring buffer, of fixed capacity unless L_DYNAMIC; excludes L_SLAB and L_UNROLLED; requires the portable backend
 
 /********************************************************************
 *																	*
@@ -37,6 +40,12 @@ PUBLIC hLIST ListCreate (int nNodes, Dword SizeOfObject, FLAGS Settings);
 // Input:	A node count, per-element size, and list settings
 // Return:	A handle to the new list
 
+PUBLIC hLIST ListCreateIndexed (int nNodes, Dword SizeOfObject, FLAGS Settings, KEYOF Key, HASH Hash);
+
+// Purpose:	Creates a list object keeping a hash index of its data by key; requires the portable backend, and excludes L_RING
+// Input:	A node count, per-element size, list settings, and routines yielding a datum's key and hashing a key
+// Return:	A handle to the new list, if successful; NULL otherwise
+
 PUBLIC RETCODE ListDestroy (hLIST List);
 
 // Purpose:	Destroys a list object
@@ -79,12 +88,36 @@ PUBLIC RETCODE ListToBack (hLIST List, void * Datum);
 // Input:	A list handle, and pointer to datum to add
 // Return:	A code indicating the results of the addition
 
+PUBLIC RETCODE ListPrependArray (hLIST List, void * Data, Dword Count);
+
+// Purpose:	Adds a run of entries to the front of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+PUBLIC RETCODE ListAppendArray (hLIST List, void * Data, Dword Count);
+
+// Purpose:	Adds a run of entries to the back of the list, keeping their order
+// Input:	A list handle, pointer to data packed one after another, and count of data
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
 PUBLIC void ListDelete (hLIST List, void * Datum);
 
 // Purpose:	Deletes entry from list
 // Input:	A list handle, and pointer to datum to delete
 // Return:	No value is returned
 
+PUBLIC RETCODE ListDeleteKey (hLIST List, EQUIVAL Callback, void * Key);
+
+// Purpose:	Deletes an entry with a given key from list, through the index if the list keeps one
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	A code indicating whether an entry was deleted
+
+PUBLIC int ListDeleteIf (hLIST List, EQUIVAL Callback, void * Context);
+
+// Purpose:	Deletes every entry a routine picks out from list
+// Input:	A list handle, a routine returning nonzero for data to delete, and context to pass to routine
+// Return:	Count of entries deleted
+
 PUBLIC void ListFlush (hLIST List);
 
 // Purpose:	Flushes all entries from list
@@ -97,6 +130,12 @@ PUBLIC void * ListSearch (hLIST List, EQUIVAL Callback, void * Context);
 // Input:	A list handle, an equivalence routine, and context to equat
 // Return:	Pointer to the datum if it exists; NULL otherwise
 
+PUBLIC void * ListSearchKey (hLIST List, EQUIVAL Callback, void * Key);
+
+// Purpose:	Searches a list for a datum with a given key, through the index if the list keeps one
+// Input:	A list handle, an equivalence routine taking a datum and the key, and the key
+// Return:	Pointer to a datum with the key if one exists, not necessarily the first; NULL otherwise
+
 PUBLIC BOOL ListIsEmpty (hLIST List);
 
 // Purpose:	Used to determine whether list is empty
@@ -121,4 +160,11 @@ PUBLIC void ListExecute (hLIST List, EXECUTE Callback, void * Context);
 // Input:	A list handle, an operation to execute, and optional context to pass to routine
 // Return:	No value is returned
 
+PUBLIC void ListExecuteParallel (hLIST List, EXECUTE Callback, void * Context, Dword SizeOfContext, REDUCE Reduce, int nThreads);
+
+// Purpose:	Performs an operation on all list elements, splitting the list among several threads
+// Input:	A list handle, an operation to execute, context to pass to routine, size of context to give each thread a copy of, or 0
+//			to share it, a routine folding a thread's copy into the context, and count of threads, or 0 for one per processor
+// Return:	No value is returned
+
 #endif // LIST_H
\ No newline at end of file
@@ -9,7 +9,49 @@
 
 #include "List.h"	// Interface information
 
-#include "..\Memory\Memory.h"	// Allocation
+#include "../Memory/Memory.h"	// Allocation
+
+/********************************************************************
+*																	*
+*							Backend									*
+*																	*
+********************************************************************/
+
+// The naked-asm path requires 32-bit VCC; everywhere else, or when LIST_PORTABLE
+// is defined on the command line, lists are built from portable C
+
+#if !defined(LIST_PORTABLE) && !(defined(_MSC_VER) && defined(_M_IX86))
+	#define LIST_PORTABLE
+#endif
+
+#ifdef LIST_PORTABLE
+	#ifdef _WIN32
+		typedef HANDLE LISTTHREAD;	// Worker thread of a parallel pass
+
+		#define LIST_WORKER			DWORD WINAPI	// Return type of a worker routine
+		#define LIST_WORKER_DONE	0				// Value a worker routine returns
+
+		#define ListThreadStart(thread,routine,param)	((*(thread) = CreateThread(NULL, 0, routine, param, 0, NULL)) != NULL)
+		#define ListThreadJoin(thread)					(WaitForSingleObject(thread, INFINITE), CloseHandle(thread))
+
+		#define ListClaim(counter)	(InterlockedIncrement(counter) - 1)	// Claim a value of a shared counter
+		#define ListCpuCount()		((int) GetActiveProcessorCount(ALL_PROCESSOR_GROUPS))
+	#else
+		#include <pthread.h>
+		#include <unistd.h>
+
+		typedef pthread_t LISTTHREAD;	// Worker thread of a parallel pass
+
+		#define LIST_WORKER			void *	// Return type of a worker routine
+		#define LIST_WORKER_DONE	NULL	// Value a worker routine returns
+
+		#define ListThreadStart(thread,routine,param)	(pthread_create(thread, NULL, routine, param) == 0)
+		#define ListThreadJoin(thread)					pthread_join(thread, NULL)
+
+		#define ListClaim(counter)	__atomic_fetch_add(counter, 1, __ATOMIC_RELAXED)	// Claim a value of a shared counter
+		#define ListCpuCount()		((int) sysconf(_SC_NPROCESSORS_ONLN))
+	#endif
+#endif
 
 /********************************************************************
 *																	*
@@ -17,6 +59,8 @@
 *																	*
 ********************************************************************/
 
+#ifndef LIST_PORTABLE
+
 /* tLISTNODE offsets */
 #define _Prev 0x0	// Prev offset
 #define _Next 0x4	// Next offset
@@ -32,9 +76,62 @@
 #define _Head		  0x0C	// Head offset
 #define _Free		  0x10	// Free offset
 #define _SizeOfObject 0x14  // SizeOfObject offset
+#define _Slab		  0x18	// Slab offset
 
 /* tLIST size */
-#define LIST_SIZE 0x18
+#define LIST_SIZE 0x1C
+
+#else // LIST_PORTABLE
+
+/* tLISTNODE size */
+#define NODE_SIZE sizeof(tLISTNODE)	// Data begins at end of node
+
+#endif // LIST_PORTABLE
+
+/* Dynamic lists */
+#define LIST_BATCH 0x20	// Nodes carved together when a dynamic list's reserve runs out
+#define LIST_RUN	0x100	// Nodes an array addition takes at once, loading them while they are still in cache
+
+/* Unrolled lists */
+#define CHUNK_BYTES	0x200	// Chunks aim to span this many bytes, header included; always a power of two
+#define CHUNK_SLOTS	0x20	// Most slots per chunk, one bit each in its occupancy map
+
+/* Ring lists */
+#define RING_MIN	0x10	// Least capacity a dynamic ring list grows to
+
+/* Hash indexes */
+#define INDEX_MIN	0x10	// Least count of index slots; slots are a power of two, at most half in use
+
+/* Parallel passes */
+#define LIST_SKIP		0x40	// Most samples in a skip index, and so segments a parallel pass splits a list into
+#define LIST_THREADS	0x40	// Most threads a parallel pass runs on
+#define LIST_PARALLEL	0x400	// Fewest data a parallel pass spreads over threads
+#define LIST_LINE		0x40	// Spacing of threads' contexts, keeping each on cache lines of its own
+
+/* Settings */
+#define LIST_LAYOUTS			(L_SLAB | L_UNROLLED | L_RING)	// Storage layouts, which exclude one another
+#define LIST_PORTABLE_SETTINGS	(L_UNROLLED | L_RING)	// Settings the naked-asm path rejects
+
+/********************************************************************
+*																	*
+*							Macros									*
+*																	*
+********************************************************************/
+
+// Round a datum size up to pointer size, keeping nodes in a bank aligned
+#define LIST_ROUND(size)	(((size) + sizeof(void *) - 1) & ~(Dword)(sizeof(void *) - 1))
+
+// Find the index slot a hash starts probing from, mixing the hash's bits so that weak hashes still spread
+#define LIST_BUCKET(list,hash)	((Dword)(((hash) * 0x9E3779B9UL) & 0xFFFFFFFFUL) >> (list)->IndexShift)
+
+// Find the chunk of an unrolled list holding a datum; chunks are aligned to their size
+#define LIST_CHUNK(list,datum)	((ptLISTCHUNK)((size_t)(datum) & ~(size_t)((list)->ChunkBytes - 1)))
+
+// Address a slot of an unrolled list's chunk
+#define LIST_SLOT(list,chunk,slot)	((Pbyte) &(chunk) [BASE_EXTENT] + (slot) * (list)->Stride)
+
+// Find the slot of an unrolled list's chunk holding a datum
+#define LIST_SLOTOF(list,chunk,datum)	((Dword)((Pbyte)(datum) - (Pbyte) &(chunk) [BASE_EXTENT]) / (list)->Stride)
 
 /********************************************************************
 *																	*
@@ -53,6 +150,27 @@ typedef struct _tLISTNODE {
 	/* Byte Data []; Virtual byte stream */	
 } tLISTNODE, * ptLISTNODE;
 
+//////////////////////////////////////////////
+// _tLISTENTRY: Slot in a list's hash index //
+//////////////////////////////////////////////
+
+typedef struct _tLISTENTRY {
+	void * Datum;	// Indexed datum; NULL if slot is empty
+	Dword Hash;		// Hash of datum's key
+} tLISTENTRY, * ptLISTENTRY;
+
+//////////////////////////////////////////////////////
+// _tLISTCHUNK: Run of data slots in an unrolled list //
+//////////////////////////////////////////////////////
+
+typedef struct _tLISTCHUNK * fLISTCHUNK;// Forward reference
+typedef struct _tLISTCHUNK {
+	fLISTCHUNK Prev;// Last chunk in list
+	fLISTCHUNK Next;// Next chunk in list
+	Dword Used;		// Map of occupied slots, lowest slot in lowest bit; never empty while chunk is in list
+	/* Byte Slots []; Virtual byte stream */
+} tLISTCHUNK, * ptLISTCHUNK;
+
 ////////////////////////////////////////////
 // _tLIST: General data storage mechanism //
 ////////////////////////////////////////////
@@ -63,14 +181,59 @@ typedef struct _tLIST {
 	ptLISTNODE Head;	// Head of linked list
 	ptLISTNODE Free;	// Head of free list
 	Dword SizeOfObject;	// Size of object stored in list
+	hSLAB Slab;			// Source of nodes in slab lists
+#ifdef LIST_PORTABLE
+	ptLISTCHUNK Chunks;	// Front chunk of an unrolled list
+	ptLISTCHUNK Spare;	// Emptied chunk an unrolled list keeps for reuse
+	Dword ChunkBytes;	// Size and alignment of an unrolled list's chunks
+	Dword nSlots;		// Slots per chunk
+	Dword Stride;		// Spacing of slots in a chunk or ring
+	Pbyte Ring;			// Slots of a ring list
+	Dword Capacity;		// Count of slots in ring
+	Dword First;		// Slot holding the front datum
+	KEYOF Key;			// Routine yielding a datum's key, in indexed lists
+	HASH Hash;			// Routine hashing a key
+	ptLISTENTRY Index;	// Hash index of data, probed linearly; NULL if list keeps none
+	Dword IndexSize;	// Count of index slots
+	Dword IndexShift;	// Shift taking a mixed hash to a slot
+	void ** Skip;		// Nodes or chunks at even spacing along list, splitting it for parallel passes
+	Dword nSkip;		// Count of samples; 0 if skip index is stale
+	Dword SkipBase;		// Count of data when skip index was built
+#endif
 } tLIST, * ptLIST;
 
+#ifdef LIST_PORTABLE
+////////////////////////////////////////////////////
+// _tLISTPASS: Parallel pass shared among threads //
+////////////////////////////////////////////////////
+
+typedef struct _tLISTPASS {
+	ptLIST List;		// List being processed
+	EXECUTE Callback;	// Operation to execute
+	void * Bounds [LIST_SKIP + 2];	// First node or chunk of each segment, then the front, closing the last
+	Dword nSegments;	// Count of segments
+	long volatile Next;	// Next segment to claim
+} tLISTPASS, * ptLISTPASS;
+
+////////////////////////////////////////////////
+// _tLISTWORKER: Thread taking part in a pass //
+////////////////////////////////////////////////
+
+typedef struct _tLISTWORKER {
+	ptLISTPASS Pass;	// Pass worker takes part in
+	void * Context;		// Context worker passes to routine
+	LISTTHREAD Thread;	// Worker's thread
+	BOOL Started;		// Whether worker is running
+} tLISTWORKER, * ptLISTWORKER;
+#endif
+
 /********************************************************************
 *																	*
 *							Implementation							*
 *																	*
 ********************************************************************/
 
+#ifndef LIST_PORTABLE
 ptLIST ListStaticInit (void);
 
 // Purpose:	Used to initialize a static linked list
@@ -83,4 +246,131 @@ ptLIST ListDynamicInit (void);
 // Input:	ECX : Node count, EDX : Per-element datum size
 // Return:	Pointer to a new list
 
+void ListRefill (void);
+
+// Purpose:	Used to refill a dynamic list's reserve of nodes with a batch carved together
+// Input:	EBX : Pointer to a list with an empty reserve
+// Return:	No return value
+#else
+ptLIST ListStaticInit (int nNodes, Dword SizeOfObject);
+
+// Purpose:	Used to initialize a static linked list
+// Input:	Node count, and per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+ptLIST ListDynamicInit (Dword SizeOfObject);
+
+// Purpose:	Used to initialize a dynamic linked list
+// Input:	Per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+void ListRefill (ptLIST List);
+
+// Purpose:	Used to refill a dynamic list's reserve of nodes with a batch carved together
+// Input:	Pointer to a list with an empty reserve
+// Return:	No return value
+
+ptLISTNODE ListTakeNode (ptLIST List);
+
+// Purpose:	Used to take a node for a new datum
+// Input:	A list handle
+// Return:	Node, if successful; NULL if a static list is full or memory ran out
+
+void ListLinkNode (ptLIST List, ptLISTNODE Node, void * Datum);
+
+// Purpose:	Used to load a datum into a node and add it at the back of the list's ring
+// Input:	A list handle, node, and pointer to datum
+// Return:	No return value
+
+RETCODE ListTakeRun (ptLIST List, Dword Count, void * Nodes []);
+
+// Purpose:	Used to take a run of nodes for new data, allocating any the reserve lacks as one batch
+// Input:	A list handle, count of nodes, and array to load with them
+// Return:	A code indicating the results of the taking; on failure no node is taken
+
+RETCODE ListAddArray (ptLIST List, Pbyte Data, Dword Count, BOOL Front);
+
+// Purpose:	Used to add a run of data at either end of a list, keeping their order
+// Input:	A list handle, pointer to packed data, their count, and whether to add at the front
+// Return:	A code indicating the results of the addition; on failure the list is unchanged
+
+ptLIST ListUnrolledInit (Dword SizeOfObject);
+
+// Purpose:	Used to initialize an unrolled linked list
+// Input:	Per-element datum size
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+RETCODE ListChunkAdd (ptLIST List, void * Datum, BOOL Front);
+
+// Purpose:	Used to add a datum at either end of an unrolled list, opening a chunk if the end one is full
+// Input:	A list handle, pointer to datum, and whether to add at the front
+// Return:	A code indicating the results of the addition
+
+void ListChunkDrop (ptLIST List, ptLISTCHUNK Chunk);
+
+// Purpose:	Used to unlink an emptied chunk from an unrolled list, keeping it as the spare or releasing it
+// Input:	A list handle, and empty chunk
+// Return:	No return value
+
+ptLIST ListRingInit (int nNodes, Dword SizeOfObject, BOOL Dynamic);
+
+// Purpose:	Used to initialize a ring list
+// Input:	Capacity, which a dynamic list takes as a hint, per-element datum size, and whether the ring may grow
+// Return:	Pointer to a new list, if successful; NULL otherwise
+
+RETCODE ListRingGrow (ptLIST List);
+
+// Purpose:	Used to double a dynamic ring list's capacity, unwrapping its data to the start of the new ring
+// Input:	A list handle
+// Return:	A code indicating the results of the growth
+
+void ListRingRemove (ptLIST List, Dword Pos);
+
+// Purpose:	Used to remove a datum from a ring list, closing the gap from whichever side is shorter
+// Input:	A list handle, and position of datum from the front
+// Return:	No return value
+
+RETCODE ListIndexReserve (ptLIST List, Dword Count);
+
+// Purpose:	Used to make room in a list's index for further data, rebuilding it larger if need be
+// Input:	A list handle, and count of data about to be added
+// Return:	A code indicating the results of the reservation
+
+void ListIndexAdd (ptLIST List, void * Datum);
+
+// Purpose:	Used to enter a datum into a list's index, which must have room
+// Input:	A list handle, and datum in list
+// Return:	No return value
+
+void ListIndexRemove (ptLIST List, void * Datum);
+
+// Purpose:	Used to take a datum out of a list's index, pulling later entries of its probe run back
+// Input:	A list handle, and datum in list
+// Return:	No return value
+
+RETCODE ListSkipBuild (ptLIST List);
+
+// Purpose:	Used to rebuild a list's skip index, sampling nodes or chunks at even spacing along it
+// Input:	A list handle
+// Return:	A code indicating the results of the rebuild
+
+void ListSkipDrop (ptLIST List, void * Item, void * Next);
+
+// Purpose:	Used to keep a list's skip index valid as a node or chunk leaves, moving its sample onto the successor
+// Input:	A list handle, departing node or chunk, already out of the front, and its successor
+// Return:	No return value
+
+void ListRunSegment (ptLISTPASS Pass, Dword Segment, void * Context);
+
+// Purpose:	Used to perform a pass's operation on one segment of its list
+// Input:	A pass, segment index, and context to pass to routine
+// Return:	No return value
+
+LIST_WORKER ListWorker (void * Param);
+
+// Purpose:	Used to claim and run a pass's segments until none are left
+// Input:	A worker
+// Return:	No meaningful value
+#endif
+
 #endif // I_LIST_H
\ No newline at end of file
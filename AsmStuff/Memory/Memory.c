@@ -14,236 +14,3597 @@
 
 PRIVATE mMEMORY MemMgr;	// Memory manager; linkage restricted to memory library
 
+#ifdef MEM_PORTABLE
+
+PRIVATE Dword MemGeneration;// Count of initializations; invalidates caches left from earlier managers
+
+PRIVATE MEM_TLS ptMEMCACHE MemCache;	// Calling thread's cache
+PRIVATE MEM_TLS Dword MemCacheGeneration;	// Manager generation the calling thread's cache belongs to
+
+PRIVATE MEMLOCK MemTraceLock;	// Lock serializing trace records with the start and end of the trace
+PRIVATE FILE * MemTraceFile;// File receiving the trace, if tracing; read and written under the trace lock
+PRIVATE Dword MemTraceLive;	// Whether a trace is running, for callers checking without the lock; adjusted through MemTally
+PRIVATE unsigned long long MemTraceBase;// Tick at which tracing began
+PRIVATE char MemTraceBuffer [BUFSIZ];	// Buffer of the trace stream, so stdio never allocates one from the manager
+PRIVATE MEM_TLS Byte MemTraceBusy;	// Set while the calling thread writes a record, so allocations stdio makes meanwhile go unrecorded
+
+#ifdef _WIN32
+	// Current tick, in microseconds
+	PRIVATE unsigned long long MemTicks (void)
+	{
+		LARGE_INTEGER Count, Freq;	// Performance counter and its rate
+
+		QueryPerformanceCounter (&Count);
+		QueryPerformanceFrequency (&Freq);
+
+		return Count.QuadPart / Freq.QuadPart * 1000000 + Count.QuadPart % Freq.QuadPart * 1000000 / Freq.QuadPart;
+	}
+#else
+	// Current tick, in microseconds
+	PRIVATE unsigned long long MemTicks (void)
+	{
+		struct timespec Now;// Monotonic time
+
+		clock_gettime (CLOCK_MONOTONIC, &Now);
+
+		return (unsigned long long) Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+	}
+#endif
+
+#ifndef _WIN32
+	// Map zeroed pages, yielding NULL on failure
+	PRIVATE void * MemMapAnonymous (Dword Bytes)
+	{
+		void * Pages = mmap (NULL, Bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		return Pages != MAP_FAILED ? Pages : NULL;
+	}
+#endif
+
+#ifdef MEM_SSE2
+	// Zero memory with vector stores, streaming large clears past the cache
+	PRIVATE void MemZero (void * Memory, size_t Bytes)
+	{
+		__m128i Zero = _mm_setzero_si128 ();// Vector of zeroes
+
+		Pbyte Dest = (Pbyte) Memory, End = Dest + Bytes;// Range to clear
+
+		if (Bytes < MEM_WIDE)	// Small clears gain nothing from vectors
+		{
+			memset (Memory, 0, Bytes);
+
+			return;
+		}
+
+		memset (Dest, 0, (0 - (size_t) Dest) & 15);	// Clear up to a 16-byte boundary
+
+		Dest += (0 - (size_t) Dest) & 15;
+
+		if (Bytes >= MEM_STREAM)// Clear with non-temporal stores
+		{
+			for (; Dest + 64 <= End; Dest += 64)
+			{
+				_mm_stream_si128 ((__m128i *) Dest, Zero);
+				_mm_stream_si128 ((__m128i *) Dest + 1, Zero);
+				_mm_stream_si128 ((__m128i *) Dest + 2, Zero);
+				_mm_stream_si128 ((__m128i *) Dest + 3, Zero);
+			}
+
+			_mm_sfence ();
+		}
+
+		else for (; Dest + 64 <= End; Dest += 64)	// Clear with aligned stores
+		{
+			_mm_store_si128 ((__m128i *) Dest, Zero);
+			_mm_store_si128 ((__m128i *) Dest + 1, Zero);
+			_mm_store_si128 ((__m128i *) Dest + 2, Zero);
+			_mm_store_si128 ((__m128i *) Dest + 3, Zero);
+		}
+
+		memset (Dest, 0, End - Dest);	// Clear the tail
+	}
+#else
+	#define MemZero(memory,bytes)	memset(memory, 0, bytes)// Zero memory
+#endif
+
+#if defined(__GNUC__)
+	#define MemLowBit(bits)		__builtin_ctzll(bits)	// Index of lowest set bit
+	#define MemHighBit(bits)	(63 - __builtin_clzll(bits))// Index of highest set bit
+#else
+	// Index of lowest set bit
+	PRIVATE int MemLowBit (unsigned long long bits)
+	{
+		int index = 0;	// Bit index
+
+		while (!(bits & 1)) bits >>= 1, ++index;
+
+		return index;
+	}
+
+	// Index of highest set bit
+	PRIVATE int MemHighBit (unsigned long long bits)
+	{
+		int index = 0;	// Bit index
+
+		while (bits >>= 1) ++index;
+
+		return index;
+	}
+#endif
+
+#endif // MEM_PORTABLE
+
+// Key grouping a used block by allocation site: its return address, its text pattern, or 0 if untagged
+PRIVATE unsigned long long MemSiteKey (ptMEMBLOCK MemBlock)
+{
+	unsigned long long Key = 0;	// Pattern bytes
+
+	int index;	// Loop variable
+
+	memcpy (&Key, MemBlock->Pattern, sizeof(MemBlock->Pattern));
+
+	if (Key & SITE_BIT)	// Return addresses are marked
+		return Key;
+
+	for (index = 0; index < 8 && MemBlock->Pattern [index] != '\0'; ++index)	// Patterns must be printable text
+		if (MemBlock->Pattern [index] < 0x20 || MemBlock->Pattern [index] > 0x7E) return 0;
+
+	Key = 0;// Ignore bytes past the pattern's end
+
+	memcpy (&Key, MemBlock->Pattern, index);
+
+	return Key;
+}
+
+// Add a used block to the site table
+PRIVATE void MemTallySite (puMSITE Table, Dword Mask, ptMEMBLOCK MemBlock, Dword Bytes)
+{
+	unsigned long long Key = MemSiteKey (MemBlock);	// Block's site
+
+	Dword slot = (Dword)((Key ^ Key >> 29) * 0x9E3779B1) & Mask;// Probe start
+
+	while (Table [slot].Count != 0 && Table [slot].Site != Key) slot = (slot + 1) & Mask;
+
+	Table [slot].Site = Key;
+	Table [slot].Bytes += Bytes;
+
+	++Table [slot].Count;
+}
+
+// Order contexts by ascending address
+PRIVATE int MemCompareAddresses (void const * First, void const * Second)
+{
+	Pbyte A = *(Pbyte const *) First, B = *(Pbyte const *) Second;	// Contexts
+
+	return A < B ? -1 : A > B ? +1 : 0;
+}
+
+// Order sites by descending footprint
+PRIVATE int MemCompareSites (void const * First, void const * Second)
+{
+	Dword A = ((puMSITE) First)->Bytes, B = ((puMSITE) Second)->Bytes;	// Footprints
+
+	return A < B ? +1 : A > B ? -1 : 0;
+}
+
+/********************************************************************************
+*																				*
+*								MemInit											*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Initializes a memory manager
+// Input:   No input
+// Return:  A code indicating the results of the initialization 
+
+RETCODE MemInit (uMCONFIG * Config)
+{
+	Dword PoolSize = MEM_ROUND(Config->PoolSize);	// Get requested size of memory frame
+
+	ZeroMemory(&MemMgr,sizeof(mMEMORY));// Empty all bins
+
+	if (PoolSize < BLOCK_SIZE)	// Ascertain that the pool can hold a block
+		return RETCODE_FAILURE;	// Return failure
+
+#ifndef MEM_PORTABLE
+	if (Config->Settings & (MEM_THREADSAFE | MEM_GUARD | MEM_CALLSITES | MEM_DEFER))	// The naked path neither locks, guards, attributes nor defers
+		return RETCODE_FAILURE;	// Return failure
+
+	if (Config->Placement != MEM_FIRST_FIT)	// The naked path only places by first fit
+		return RETCODE_FAILURE;	// Return failure
+
+	if (Config->MapThreshold != 0)	// The naked path only allocates from the pool
+		return RETCODE_FAILURE;	// Return failure
+#else
+	if (Config->Placement > MEM_ADDRESS_FIT)// Ascertain that the placement policy is known
+		return RETCODE_FAILURE;	// Return failure
+#endif
+
+	MemMgr.Pool = (ptMEMBLOCK) MemSysAlloc(PoolSize);
+	// Allocate memory for manager object and pool; fresh pages come zeroed
+
+	if (MemMgr.Pool == NULL)	// Ascertain that allocation succeeded
+		return RETCODE_FAILURE;	// Return failure
+
+	MemMgr.Pool->Size = PoolSize - sizeof(tMEMBLOCK);	// Set pool amount available
+	MemMgr.Pool->Prev = MemMgr.Pool->Next = MemMgr.Pool;// Link pool entries to self
+
+#ifdef MEM_PORTABLE
+	MemHeapSetup (&MemMgr, Config);	// Initialize the memory pool
+
+	MemLockInit(&MemTraceLock);	// Prepare lock for tracing, which any thread may start
+
+	++MemGeneration;// Invalidate caches left over from earlier managers
+#else
+	_asm {
+		mov esi, [MemMgr]._Pool;/* Initialize the memory pool */
+		call MemInsertIntoFreeBlocks;
+	}
+#endif
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemTerm											*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Deinitializes a memory manager
+// Input:   Optional name of a log file
+// Return:  A code indicating the results of the termination
+
+RETCODE MemTerm (char const * LogFile)
+{		
+#ifdef MEM_PORTABLE
+	MemTraceStop ();	// Finish any trace
+
+	if (MemMgr.Settings & MEM_THREADSAFE)	// Return every thread's cached blocks; threads are assumed finished
+	{
+		while (MemMgr.Caches != NULL)
+		{
+			ptMEMCACHE Cache = MemMgr.Caches;	// Refer to first registered cache
+
+			MemMgr.Caches = Cache->Next;
+
+			MemCacheFlush (Cache);
+
+			MemSysFree(Cache, sizeof(tMEMCACHE));
+		}
+	}
+
+	++MemGeneration;// Threads' cache pointers now dangle; a later MemThreadTerm must ignore them
+
+	MemDrainQuarantine (&MemMgr);	// Blocks held back were released by the user
+
+	MemCompactHeap (&MemMgr);	// So were blocks awaiting coalescing
+#endif
+
+	if (LogFile != NULL)	// User requests diagnostics
+	{
+		ptMEMBLOCK MemBlock = MemMgr.Pool;	// Refer to first memory block
+
+		FILE * fpLog;	// File used to log debug info
+
+		char Pattern [9] = {0};	// Buffer used to retrieve memory patterns
+
+		Dword nUnfreed = MemMgr.nUsed;	// Count of used blocks
+
+#ifdef MEM_PORTABLE
+		nUnfreed += MemMgr.nDirect;	// Mapped blocks lie outside the chain
+#endif
+
+		fpLog = fopen (LogFile, "wt");	// Create a log file
+
+		if (fpLog != NULL)	// Log diagnostics if file creation was successful
+		{
+			// Output used entry/byte information
+			fprintf (fpLog, "%lu unfreed entries\n", (unsigned long) nUnfreed);
+
+			fprintf (fpLog, MemVerify (&MemMgr) == RETCODE_SUCCESS ? "Heap intact\n" : "Heap damaged\n");
+
+#ifdef MEM_PORTABLE
+			if (MemMgr.Settings & MEM_CALLSITES)// List unfreed memory by site instead
+			{
+				puMSITE Sites = (puMSITE) calloc (nUnfreed + 1, sizeof(uMSITE));	// Sites of unfreed blocks
+
+				Dword nSites, index;// Count of sites, and loop variable
+
+				nSites = Sites != NULL ? MemGetSites (&MemMgr, Sites, nUnfreed + 1) : 0;
+
+				for (index = 0; index < nSites; ++index)
+				{
+					if (Sites [index].Site != 0) fprintf (fpLog, "Site: 0x%llx", Sites [index].Site);
+
+					else if (Sites [index].Tag [0] != '\0') fprintf (fpLog, "Entry: %s", Sites [index].Tag);
+
+					else fprintf (fpLog, "No pattern");
+
+					fprintf (fpLog, ", bytes used: %lu in %lu entries\n", (unsigned long) Sites [index].Bytes, (unsigned long) Sites [index].Count);
+				}
+
+				free (Sites);
+			}
+
+			else
+#endif
+			if (MemMgr.nUsed != 0) do {	// If memory is unfreed, list instances
+				if ((MemBlock->Size & (MEM_USED | MEM_FENCE)) == MEM_USED)	// Check if memory block is not freed
+				{
+					// Retrieve memory pattern
+					MemGetPattern (&MemBlock [BASE_EXTENT], Pattern);
+
+					if (Pattern [0] == '\0')	// Check for unlabeled blocks
+						fprintf (fpLog, "No pattern\n");	// Print message
+
+					else fprintf (fpLog, "Entry: %s\n", Pattern);	// Print pattern
+
+					fprintf (fpLog, "Bytes used: %lu\n", (unsigned long)(MemBlock->Size ^ MEM_USED));	// Print memory consumption
+				}
+
+				MemBlock = MemBlock->Next;	// Go to next block in memory chain
+			} while (MemBlock != MemMgr.Pool);	// Loop through all blocks
+
+#ifdef MEM_PORTABLE
+			if (!(MemMgr.Settings & MEM_CALLSITES))	// List unfreed mapped blocks as well
+				for (MemBlock = MemMgr.Direct; MemBlock != NULL; MemBlock = MemBlock->Next)
+				{
+					MemGetPattern (&MemBlock [BASE_EXTENT], Pattern);
+
+					if (Pattern [0] == '\0')	// Check for unlabeled blocks
+						fprintf (fpLog, "No pattern\n");	// Print message
+
+					else fprintf (fpLog, "Entry: %s\n", Pattern);	// Print pattern
+
+					fprintf (fpLog, "Bytes used: %lu\n", (unsigned long)(MemBlock->Size & ~(Dword) MEM_DIRECT));
+				}
+#endif
+
+			fclose (fpLog);	// Close the log file
+		}
+	}
+
+#ifdef MEM_PORTABLE
+	if (MemMgr.Settings & MEM_THREADSAFE)	// Retire locks
+		MemLockTerm(&MemMgr.Lock);
+
+	MemLockTerm(&MemTraceLock);
+
+	MemReleaseSegments (&MemMgr);	// Unmap any growth segments and mapped blocks
+#endif
+
+	MemSysFree(MemMgr.Pool, MemMgr.PoolBytes);	// Deallocate memory manager pool; segments are already gone
+
+	ZeroMemory(&MemMgr,sizeof(mMEMORY));// Clear manager
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+#ifdef MEM_PORTABLE
+
+/********************************************************************************
+*																				*
+*								MemAlloc										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size
+// Input:   Block size, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemAlloc (Dword numBytes, FLAGS Options)
+{
+	void * memory = MemAllocKeyed (&MemMgr, numBytes, Options, MEM_SITE(&MemMgr));	// Allocate from the global manager, attributed to the caller
+
+	if (MEM_TRACING())	// Record allocation
+		MemTraceRecord (MEM_TRACE_ALLOC, numBytes, Options, 0, memory, 0);
+
+	return memory;
+	// Return pointer to allocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemFree											*
+*																				*
+********************************************************************************/	
+
+// Purpose: Used to release memory
+// Input:   Context to release
+// Return:  No return value
+
+void MemFree (void * memory)
+{
+	if (MEM_TRACING())	// Record release while the block is still owned
+		MemTraceRecord (MEM_TRACE_FREE, 0, 0, 0, memory, 0);
+
+	MemHeapFree (&MemMgr, memory);	// Release to the global manager
+}
+
+/********************************************************************************
+*																				*
+*								MemRealloc										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to resize memory, in place where the pool allows
+// Input:	Context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * MemRealloc (void * memory, Dword numBytes)
+{
+	void * Resized;	// Resized memory
+
+	if (!MEM_TRACING())	// Resize within the global manager, attributing a new block to the caller
+		return MemReallocKeyed (&MemMgr, memory, numBytes, MEM_SITE(&MemMgr));
+
+	MemLock(&MemTraceLock);	// Hold other records back until the resize is recorded, so none records reuse of the old block first
+
+	Resized = MemReallocKeyed (&MemMgr, memory, numBytes, MEM_SITE(&MemMgr));
+
+	MemTraceWrite (MEM_TRACE_REALLOC, numBytes, 0, 0, Resized, (size_t) memory);
+
+	MemUnlock(&MemTraceLock);
+
+	return Resized;
+	// Return pointer to resized memory
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocAligned									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size at a given alignment
+// Input:	Block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemAllocAligned (Dword numBytes, Dword Alignment, FLAGS Options)
+{
+	void * memory = MemAllocAlignedKeyed (&MemMgr, numBytes, Alignment, Options, MEM_SITE(&MemMgr));	// Allocate from the global manager, attributed to the caller
+
+	if (MEM_TRACING())	// Record allocation
+		MemTraceRecord (MEM_TRACE_ALLOC, numBytes, Options, Alignment, memory, 0);
+
+	return memory;
+	// Return pointer to allocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocBatch									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate several blocks of one size at once, carved from a single free block where the pool allows
+// Input:	Count of blocks, block size, array to load, and options
+// Return:	Count of blocks allocated, which falls short of the count only if memory runs out
+
+Dword MemAllocBatch (Dword Count, Dword numBytes, void * Blocks [], FLAGS Options)
+{
+	ptMEMBLOCK MemBlock;// Block carved for the batch, then each block of it
+
+	Pbyte Stale = NULL;	// End of bytes that may be non-zero; all of them, if unknown
+
+	Dword Size = MEM_ROUND(numBytes), Span = Size + BLOCK_SIZE;	// Request size, and spacing of blocks
+	Dword nTaken = 0, index;	// Count of blocks, and loop variable
+
+	unsigned long long Key = MEM_SITE(&MemMgr);	// Blocks are attributed to the caller
+
+	if (Count == 0)	// Ascertain that blocks are requested
+		return 0;
+
+	if ((MemMgr.Settings & MEM_GUARD) || (MemMgr.MapThreshold != 0 && numBytes >= MemMgr.MapThreshold) || Count > ((Dword) ~0 - Size) / Span)
+	{
+		while (nTaken < Count && (Blocks [nTaken] = MemAllocKeyed (&MemMgr, numBytes, Options, Key)) != NULL)
+			++nTaken;	// Guarded, mapped and outsized batches are taken a block at a time
+	}
+
+	else
+	{
+		if (MemMgr.Settings & MEM_THREADSAFE) MemLock(&MemMgr.Lock);	// One lock covers the batch; it bypasses thread caches
+
+		if (MemSplitBatch (&MemMgr, Size, Count, Blocks, Key) == RETCODE_SUCCESS)	// Carve the whole batch as one block, divided into its blocks
+		{
+			Stale = MemMgr.Stale;
+
+			nTaken = Count;
+		}
+
+		else while (nTaken < Count && (MemBlock = MemTakeBlock (&MemMgr, Size, Key)) != NULL)	// Otherwise carve blocks wherever they fit
+			Blocks [nTaken++] = &MemBlock [BASE_EXTENT];
+
+		if (MemMgr.Settings & MEM_THREADSAFE) MemUnlock(&MemMgr.Lock);
+
+		if (Options & MEM_ZERO)	// If requested, zero out the blocks' memory
+			for (index = 0; index < nTaken; ++index)
+				MemClearBlock ((ptMEMBLOCK) Blocks [index] - BASE_EXTENT, Stale);
+	}
+
+	if (MEM_TRACING())	// Record allocations one by one
+		for (index = 0; index < nTaken; ++index)
+			MemTraceRecord (MEM_TRACE_ALLOC, numBytes, Options, 0, Blocks [index], 0);
+
+	return nTaken;
+	// Return count of blocks allocated
+}
+
+/********************************************************************************
+*																				*
+*								MemFreeBatch									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release several blocks at once, merging neighbours among them before they rejoin the pool
+// Input:	Contexts to release, which are left sorted by address, and their count; NULL entries are skipped
+// Return:	No return value
+
+void MemFreeBatch (void * Blocks [], Dword Count)
+{
+	ptMEMBLOCK MemBlock, Next;	// Block being released, and its physical successor
+
+	Dword index, next;	// Loop variables
+
+	for (index = 0; index < Count; ++index)	// Handle blocks that do not rejoin the pool
+	{
+		if (Blocks [index] == NULL)
+			continue;
+
+		if (MEM_TRACING())	// Record releases while the blocks are still owned
+			MemTraceRecord (MEM_TRACE_FREE, 0, 0, 0, Blocks [index], 0);
+
+		MemBlock = (ptMEMBLOCK) Blocks [index] - BASE_EXTENT;
+
+		if ((MemMgr.Settings & MEM_GUARD) || (MemBlock->Size & MEM_DIRECT) == MEM_DIRECT)
+		{
+			MemHeapFree (&MemMgr, Blocks [index]);	// Quarantine or unmap block on its own
+
+			Blocks [index] = NULL;
+		}
+	}
+
+	qsort (Blocks, Count, sizeof(void *), MemCompareAddresses);	// Neighbours among the blocks end up side by side
+
+	if (MemMgr.Settings & MEM_THREADSAFE) MemLock(&MemMgr.Lock);	// One lock covers the batch; it bypasses thread caches
+
+	for (index = 0; index < Count; index = next)
+	{
+		next = index + 1;
+
+		if (Blocks [index] == NULL)	// Skip handled blocks
+			continue;
+
+		MemBlock = (ptMEMBLOCK) Blocks [index] - BASE_EXTENT;
+
+		for (; next < Count && (ptMEMBLOCK) Blocks [next] - BASE_EXTENT == MemBlock->Next; ++next)
+		{
+			Next = MemBlock->Next;	// Absorb a following block of the batch, header and all
+
+			MemBlock->Size += BLOCK_SIZE + (Next->Size ^ MEM_USED);
+			MemBlock->Next = Next->Next;
+			Next->Next->Prev = MemBlock;
+
+			--MemMgr.nUsed;	// Document removal of used memory block
+		}
+
+		MemGiveBlock (&MemMgr, MemBlock);	// Return the merged run, joining any free neighbours
+	}
+
+	if (MemMgr.Settings & MEM_THREADSAFE) MemUnlock(&MemMgr.Lock);
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapCreate									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Creates an independent heap
+// Input:	Pointer to a configuration structure
+// Return:	A handle to the new heap, if successful; NULL otherwise
+
+hHEAP MemHeapCreate (puMCONFIG Config)
+{
+	pmMEMORY Heap;	// New heap
+
+	Dword PoolSize = MEM_ROUND(Config->PoolSize);	// Get requested size of memory frame
+
+	if (PoolSize < BLOCK_SIZE)	// Ascertain that the pool can hold a block
+		return NULL;
+
+	if (Config->Placement > MEM_ADDRESS_FIT)// Ascertain that the placement policy is known
+		return NULL;
+
+	Heap = (pmMEMORY) calloc (1, MEM_ROUND(sizeof(mMEMORY)) + PoolSize);
+	// Allocate manager and pool together, so destruction is a single release; bins start empty
+
+	if (Heap == NULL)	// Ascertain that calloc succeeded
+		return NULL;
+
+	Heap->Pool = (ptMEMBLOCK)((Pbyte) Heap + MEM_ROUND(sizeof(mMEMORY)));	// Pool follows manager
+
+	Heap->Pool->Size = PoolSize - BLOCK_SIZE;	// Set pool amount available
+	Heap->Pool->Prev = Heap->Pool->Next = Heap->Pool;	// Link pool entries to self
+
+	MemHeapSetup (Heap, Config);// Initialize the memory pool
+
+	return Heap;
+	// Return new heap
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapDestroy									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Destroys a heap, along with everything allocated from it
+// Input:	A heap handle
+// Return:	A code indicating the results of the destruction
+
+RETCODE MemHeapDestroy (hHEAP Heap)
+{
+	if (Heap == NULL || Heap == &MemMgr)// Only created heaps may be destroyed
+		return RETCODE_FAILURE;
+
+	if (Heap->Settings & MEM_THREADSAFE)// Retire lock
+		MemLockTerm(&Heap->Lock);
+
+	MemReleaseSegments (Heap);	// Unmap any growth segments and mapped blocks
+
+	free (Heap);// Release manager and initial pool at once; blocks are never visited
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapAlloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size from a heap
+// Input:	A heap handle, block size, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemHeapAlloc (hHEAP Heap, Dword numBytes, FLAGS Options)
+{
+	return MemAllocKeyed (Heap, numBytes, Options, MEM_SITE(Heap));
+	// Return pointer to allocated memory, attributed to the caller
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocKeyed									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory of a given size from a heap, stamping its block with a key
+// Input:	Heap, block size, options, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemAllocKeyed (pmMEMORY Heap, Dword numBytes, FLAGS Options, unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock;// Allocated block
+
+	Pbyte Stale = NULL;	// End of bytes that may be non-zero; all of them, if unknown
+
+	Dword Size = MEM_ROUND(numBytes);	// Align request to allocation granularity
+
+	if (Heap->Settings & MEM_GUARD)	// Leave room for a trailer
+		Size = MEM_ROUND(numBytes + GUARD_BYTES);
+
+	if (Heap->MapThreshold != 0 && numBytes >= Heap->MapThreshold)	// Map large blocks on pages of their own
+	{
+		MemBlock = MemMapBlock (Heap, Size, MEM_GRAIN, Key);
+
+		if (MemBlock != NULL) Stale = (Pbyte) &MemBlock [BASE_EXTENT];	// Fresh pages come zeroed
+	}
+
+	else if (!(Heap->Settings & MEM_THREADSAFE))	// Carve block directly out of pool
+	{
+		MemBlock = MemTakeBlock (Heap, Size, Key);
+
+		Stale = Heap->Stale;
+	}
+
+	else if (Heap == &MemMgr && Size != 0 && Size < SMALL_LIMIT && Key == 0)	// Take small blocks from thread cache; its blocks carry no key
+		MemBlock = MemCacheAlloc (Size);
+
+	else// Carve other blocks out of pool under lock
+	{
+		MemLock(&Heap->Lock);
+
+		MemBlock = MemTakeBlock (Heap, Size, Key);
+
+		Stale = Heap->Stale;
+
+		MemUnlock(&Heap->Lock);
+	}
+
+	if (MemBlock == NULL)	// If no blocks were found, return NULL
+		return NULL;
+
+	if (Options & MEM_ZERO)	// If requested, zero out the block's memory
+		MemClearBlock (MemBlock, Stale);
+
+	if ((Heap->Settings & MEM_GUARD) && (MemBlock->Size & MEM_DIRECT) != MEM_DIRECT)	// Mark the end of the request; unmapping guards mapped blocks
+		MemGuardBlock (MemBlock, numBytes);
+
+	return &MemBlock [BASE_EXTENT];
+	// Return pointer to allocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapFree										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release memory to a heap
+// Input:	A heap handle, and context to release
+// Return:	No return value
+
+void MemHeapFree (hHEAP Heap, void * memory)
+{
+	ptMEMBLOCK MemBlock = (ptMEMBLOCK) memory - BASE_EXTENT;// Obtain the block preceding the memory variable
+
+	if ((MemBlock->Size & MEM_DIRECT) == MEM_DIRECT)// Return a mapped block's pages at once
+	{
+		MemUnmapBlock (Heap, MemBlock);
+
+		return;
+	}
+
+	if (Heap->Settings & MEM_GUARD)	// Hold block back, releasing the oldest quarantined block instead
+	{
+		MemBlock = MemQuarantineBlock (Heap, MemBlock);
+
+		if (MemBlock == NULL)	// Quarantine still had room
+			return;
+	}
+
+	if (!(Heap->Settings & MEM_THREADSAFE))	// Put block directly back into pool
+		MemDeferBlock (Heap, MemBlock);
+
+	else if (Heap == &MemMgr)	// Put block into thread cache
+		MemCacheFree (MemBlock);
+
+	else// Put block back into pool under lock
+	{
+		MemLock(&Heap->Lock);
+
+		MemDeferBlock (Heap, MemBlock);
+
+		MemUnlock(&Heap->Lock);
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapRealloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to resize memory from a heap, in place where the heap allows
+// Input:	A heap handle, context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * MemHeapRealloc (hHEAP Heap, void * memory, Dword numBytes)
+{
+	return MemReallocKeyed (Heap, memory, numBytes, MEM_SITE(Heap));
+	// Return pointer to resized memory, attributing a new block to the caller
+}
+
+/********************************************************************************
+*																				*
+*								MemReallocKeyed									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to resize memory from a heap, in place where the heap allows
+// Input:	Heap, context to resize, or NULL to allocate a block stamped with the key, new block size, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * MemReallocKeyed (pmMEMORY Heap, void * memory, Dword numBytes, unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock;// Block preceding the memory variable
+
+	RETCODE Result;	// Result of in-place resize
+
+	void * Moved;	// Memory of relocated block
+
+	Dword Size = MEM_ROUND(numBytes), Have;	// New size of block, and bytes to carry over
+
+	if (memory == NULL)	// Without a context, simply allocate
+		return MemAllocKeyed (Heap, numBytes, 0, Key);
+
+	MemBlock = (ptMEMBLOCK) memory - BASE_EXTENT;	// Obtain the block preceding the memory variable
+
+	if (Heap->Settings & MEM_GUARD)	// Leave room for a trailer
+		Size = MEM_ROUND(numBytes + GUARD_BYTES);
+
+	if ((MemBlock->Size & MEM_DIRECT) == MEM_DIRECT)// A mapped block stays put while its pages fit and the request still warrants them
+	{
+		Have = MemBlock->Size & ~(Dword) MEM_DIRECT;
+
+		if (numBytes >= Heap->MapThreshold && Size <= Have)
+			return memory;
+
+		if (Have > numBytes) Have = numBytes;	// Shrinking relocates too
+	}
+
+	else
+	{
+		if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);	// Neighbours belong to the pool
+
+		Have = Heap->Settings & MEM_GUARD ? MemGuardCheck (MemBlock) : MemBlock->Size ^ MEM_USED;	// Only a guarded request is carried over
+
+		Result = MemResizeBlock (Heap, MemBlock, Size);
+
+		if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+		if (Result == RETCODE_SUCCESS)	// Block was resized in place
+		{
+			if (Heap->Settings & MEM_GUARD)	// Move the end of the request
+				MemGuardBlock (MemBlock, numBytes);
+
+			return memory;
+		}
+	}
+
+	memcpy (&Key, MemBlock->Pattern, sizeof(MemBlock->Pattern));	// Carry pattern over in the relocated block's key
+
+	Moved = MemAllocKeyed (Heap, numBytes, 0, Key);	// Otherwise relocate block
+
+	if (Moved == NULL)	// Ascertain that MemAllocKeyed succeeded
+		return NULL;
+
+	memcpy (Moved, memory, Have);	// Carry contents over
+
+	MemHeapFree (Heap, memory);	// Release old block
+
+	return Moved;
+	// Return pointer to relocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapAllocAligned								*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size at a given alignment from a heap
+// Input:	A heap handle, block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemHeapAllocAligned (hHEAP Heap, Dword numBytes, Dword Alignment, FLAGS Options)
+{
+	return MemAllocAlignedKeyed (Heap, numBytes, Alignment, Options, MEM_SITE(Heap));
+	// Return pointer to allocated memory, attributed to the caller
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocAlignedKeyed							*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory of a given size at a given alignment from a heap, stamping its block with a key
+// Input:	Heap, block size, power-of-two alignment, options, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemAllocAlignedKeyed (pmMEMORY Heap, Dword numBytes, Dword Alignment, FLAGS Options, unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock;// Allocated block
+
+	Pbyte Stale = NULL;	// End of bytes that may be non-zero
+
+	Dword Size = MEM_ROUND(numBytes);	// Align request to allocation granularity
+
+	if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0)	// Ascertain that alignment is a power of two
+		return NULL;
+
+	if (Alignment <= MEM_GRAIN)	// Every block meets the granularity
+		return MemAllocKeyed (Heap, numBytes, Options, Key);
+
+	if (Heap->Settings & MEM_GUARD)	// Leave room for a trailer
+		Size = MEM_ROUND(numBytes + GUARD_BYTES);
+
+	if (Heap->MapThreshold != 0 && numBytes >= Heap->MapThreshold && Alignment <= MAP_PAGE)	// Map large blocks on pages of their own
+	{
+		MemBlock = MemMapBlock (Heap, Size, Alignment, Key);
+
+		if (MemBlock != NULL) Stale = (Pbyte) &MemBlock [BASE_EXTENT];	// Fresh pages come zeroed
+	}
+
+	else
+	{
+		if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);	// Aligned blocks bypass thread caches
+
+		MemBlock = MemTakeBlock (Heap, Size + Alignment + BLOCK_SIZE, Key);	// Leave room for slack on either side
+
+		if (MemBlock != NULL)	// Free the leading slack, then the trailing slack
+		{
+			Stale = Heap->Stale;// Aligned block lies within the block first carved
+
+			MemBlock = MemAlignBlock (Heap, MemBlock, Alignment);
+
+			MemSplitBlock (Heap, MemBlock, Size);
+
+			MemSetKey (MemBlock, Key);	// Aligned block has a header of its own
+		}
+
+		if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+	}
+
+	if (MemBlock == NULL)	// If no blocks were found, return NULL
+		return NULL;
+
+	if (Options & MEM_ZERO)	// If requested, zero out the block's memory
+		MemClearBlock (MemBlock, Stale);
+
+	if ((Heap->Settings & MEM_GUARD) && (MemBlock->Size & MEM_DIRECT) != MEM_DIRECT)	// Mark the end of the request; unmapping guards mapped blocks
+		MemGuardBlock (MemBlock, numBytes);
+
+	return &MemBlock [BASE_EXTENT];
+	// Return pointer to allocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemThreadTerm									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Returns the calling thread's cached blocks to a thread-safe manager
+// Input:	No input
+// Return:	No return value
+
+void MemThreadTerm (void)
+{
+	if (MemCacheGeneration != MemGeneration || MemCache == NULL)	// Ignore threads without a live cache
+		return;
+
+	MemLock(&MemMgr.Lock);
+
+	MemCacheFlush (MemCache);	// Return blocks to pool
+
+	if (MemCache->Prev != NULL) MemCache->Prev->Next = MemCache->Next;	// Unlink cache from registry
+	else MemMgr.Caches = MemCache->Next;
+
+	if (MemCache->Next != NULL) MemCache->Next->Prev = MemCache->Prev;
+
+	MemUnlock(&MemMgr.Lock);
+
+	MemSysFree(MemCache, sizeof(tMEMCACHE));
+
+	MemCache = NULL;
+	MemCacheGeneration = 0;
+}
+
+/********************************************************************************
+*																				*
+*								MemCompact										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to coalesce a heap's deferred blocks into its free blocks
+// Input:	A heap handle, or NULL for the global manager
+// Return:	A code indicating the results of the compaction
+
+RETCODE MemCompact (hHEAP Heap)
+{
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	if (Heap->Pool == NULL)	// Ascertain that the heap is live
+		return RETCODE_FAILURE;
+
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+	MemCompactHeap (Heap);
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemTraceStart									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Begins recording the global manager's operations to a trace file
+// Input:	Name of the trace file
+// Return:	A code indicating the results of starting the trace
+
+RETCODE MemTraceStart (char const * TraceFile)
+{
+	FILE * fpTrace = NULL;	// File receiving the trace
+
+	if (MemMgr.Pool == NULL)// Ascertain that the manager, and so the trace lock, is live
+		return RETCODE_FAILURE;
+
+	MemLock(&MemTraceLock);
+
+	if (MemTraceFile == NULL)	// Ascertain that no trace is running
+		fpTrace = fopen (TraceFile, "wb");	// Create the trace file
+
+	if (fpTrace != NULL)// Publish trace once fopen succeeded
+	{
+		setvbuf (fpTrace, MemTraceBuffer, _IOFBF, sizeof(MemTraceBuffer));
+
+		MemTraceBase = MemTicks ();	// Times are relative to the start of the trace
+
+		MemTraceFile = fpTrace;
+
+		MemTally(&MemTraceLive, 1);
+	}
+
+	MemUnlock(&MemTraceLock);
+
+	return fpTrace != NULL ? RETCODE_SUCCESS : RETCODE_FAILURE;
+	// Return result
+}
+
+/********************************************************************************
+*																				*
+*								MemTraceStop									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Ends recording the global manager's operations
+// Input:	No input
+// Return:	A code indicating the results of ending the trace
+
+RETCODE MemTraceStop (void)
+{
+	FILE * fpTrace;	// File receiving the trace
+
+	if (MemMgr.Pool == NULL)// Ascertain that the manager, and so the trace lock, is live
+		return RETCODE_FAILURE;
+
+	MemLock(&MemTraceLock);	// Wait out records being written
+
+	fpTrace = MemTraceFile;
+
+	if (fpTrace != NULL)// Stop recording, then close the file before another trace may reuse its buffer
+	{
+		MemTraceFile = NULL;
+
+		MemTally(&MemTraceLive, -1);
+
+		fclose (fpTrace);
+	}
+
+	MemUnlock(&MemTraceLock);
+
+	return fpTrace != NULL ? RETCODE_SUCCESS : RETCODE_FAILURE;
+	// Return result
+}
+
+#else // MEM_PORTABLE
+
+/********************************************************************************
+*																				*
+*								MemAlloc										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size
+// Input:   Block size, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+QUICK void * MemAlloc (Dword numBytes, FLAGS Options)
+{
+	_asm {
+		mov eax, [esp+4];/* Load request size */
+		add eax, 3;		/* Align request to next dword boundary; bits 0, 1 free */
+		and eax, not 3;
+		call MemBinIndex;	/* Find the bin matching the request */
+		cmp ecx, SMALL_BINS;/* Any block in an exact bin at or above the request's fits */
+		jb $fBin;
+		mov esi, [MemMgr+_Bins+ecx*4];	/* Load the request's power-of-two bin; if empty, skip ahead */
+		test esi, esi;
+		jz $fNext;
+		mov edx, esi;	/* Cache bin base */
+$fMem:	cmp [esi]._Size, eax;	/* Scan through bin, stopping at first fit */
+		jae $mGood;
+		mov esi, [esi]._nFree;
+		cmp esi, edx;
+		jne $fMem;
+$fNext:	inc ecx;/* Every block in a higher bin fits */
+$fBin:	cmp ecx, 32;/* Search the bitmap word holding the bin */
+		jae $fHigh;
+		mov edx, [MemMgr+_BinMap];	/* Discard bins below the request, and find the first non-empty one */
+		shr edx, cl;
+		bsf edx, edx;
+		jz $fLow;
+		add ecx, edx;	/* Convert to bin index, and take bin base */
+		jmp $fTake;
+$fLow:	mov ecx, 32;/* Continue into the upper bins */
+$fHigh:	mov edx, [MemMgr+_BinMap+4];/* Discard bins below the request, and find the first non-empty one */
+		sub ecx, 32;
+		shr edx, cl;
+		bsf edx, edx;
+		jz $fNone;
+		lea ecx, [ecx+edx+32];	/* Convert to bin index */
+$fTake:	mov esi, [MemMgr+_Bins+ecx*4];	/* Take bin base */
+		jmp $mGood;
+$fNone:	xor eax, eax;	/* If no blocks were found, return NULL */
+		ret;
+$mGood:	call MemRemoveFromFreeBlocks;	/* Extract the memory block from the pool */
+		mov ecx, [esi]._Size;	/* Set the new block's size, and compute the padding left over */
+		mov [esi]._Size, eax;
+		sub ecx, eax;
+		or [esi]._Size, MEM_USED;	/* Encode usage in bit 0 */
+		cmp ecx, BLOCK_SIZE;/* If padding is inadequate to form a new block plus data, skip ahead */
+		jle $mPad;
+		mov edi, esi;	/* Cache old block */
+		sub ecx, BLOCK_SIZE;/* Determine the size of new block */
+		mov ebx, [edi]._Next;	/* Load offsets of new block and block after it */
+		lea esi, [edi+eax+BLOCK_SIZE];
+		mov [esi]._Size, ecx;	/* Set the new block's size */
+		mov [esi]._Prev, edi;	/* Update the blocks' connections */
+		mov [esi]._Next, ebx;
+		mov [ebx]._Prev, esi;
+		mov [edi]._Next, esi;
+		call MemInsertIntoFreeBlocks;	/* Put the new block back into the free blocks */
+		mov esi, edi;	/* Restore old block */
+		xor ecx, ecx;	/* Zero out padding */
+$mPad:	add [esi]._Size, ecx;	/* Accumulate leftover padding into allocated block */
+		mov [esi]._Pattern, 0;	/* Effectively zero out block's pattern */
+		test [esp+8], MEM_ZERO;	/* If requested, zero out the block's memory */
+		jz $mNo0;
+		cld;
+		mov ecx, [esi]._Size;
+		xor	eax, eax;
+		shr	ecx, 2;
+		lea edi, [esi]._DATA;
+		rep stosd;
+$mNo0:	lea eax, [esi]._DATA;	/* Load pointer to allocated memory as return value */
+		inc dword ptr [MemMgr].nUsed;	/* Document addition of used memory block */
+		ret;/* Return to caller */
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemFree											*
+*																				*
+********************************************************************************/	
+
+// Purpose: Used to release memory
+// Input:   Context to release
+// Return:  No return value
+
+QUICK void MemFree (void * memory)
+{
+	_asm {
+		mov esi, [esp+4];	/* Obtain the block preceding the memory variable */
+		sub esi, BLOCK_SIZE;
+		and [esi]._Size, not MEM_USED;	/* Remove usage encoding in bit 0 */
+		call MemInsertIntoFreeBlocks;	/* Put block back into the free blocks */
+		dec dword ptr [MemMgr].nUsed;	/* Document removal of used memory block */
+		ret;/* Return to caller */
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemRealloc										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to resize memory, in place where the pool allows
+// Input:	Context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+QUICK void * MemRealloc (void * memory, Dword numBytes)
+{
+	_asm {
+		mov esi, [esp+4];	/* Load memory; if there is none, simply allocate */
+		test esi, esi;
+		jz $rNew;
+		sub esi, BLOCK_SIZE;/* Obtain the block preceding the memory variable */
+		mov eax, [esp+8];	/* Load request size */
+		add eax, 3;		/* Align request to next dword boundary; bits 0, 1 free */
+		and eax, not 3;
+		mov ecx, [esi]._Size;	/* Load current size; if it covers the request, skip ahead */
+		and ecx, not MEM_USED;
+		cmp ecx, eax;
+		jae $rFit;
+		mov edi, [esi]._Next;	/* Load next block, and check whether it's upper in memory and free */
+		cmp edi, esi;
+		jbe $rMove;
+		test [edi]._Size, MEM_USED;
+		jnz $rMove;
+		add ecx, [edi]._Size;	/* Check whether both blocks together cover the request */
+		add ecx, BLOCK_SIZE;
+		cmp ecx, eax;
+		jb $rMove;
+		push ecx;	/* Save combined size */
+		push esi;	/* Take next block out of its bin */
+		mov esi, edi;
+		call MemRemoveFromFreeBlocks;
+		pop esi;
+		pop ecx;/* Restore combined size */
+		mov edx, [edi]._Next;	/* Update blocks' connections */
+		mov [esi]._Next, edx;
+		mov [edx]._Prev, esi;
+$rFit:	sub ecx, eax;	/* Compute the padding left over */
+		cmp ecx, BLOCK_SIZE;/* If padding is inadequate to form a new block plus data, skip ahead */
+		jle $rPad;
+		mov [esi]._Size, eax;	/* Set the block's size, encoding usage in bit 0 */
+		or [esi]._Size, MEM_USED;
+		mov edi, esi;	/* Cache block */
+		sub ecx, BLOCK_SIZE;/* Determine the size of new block */
+		mov ebx, [edi]._Next;	/* Load offsets of new block and block after it */
+		lea esi, [edi+eax+BLOCK_SIZE];
+		mov [esi]._Size, ecx;	/* Set the new block's size */
+		mov [esi]._Prev, edi;	/* Update the blocks' connections */
+		mov [esi]._Next, ebx;
+		mov [ebx]._Prev, esi;
+		mov [edi]._Next, esi;
+		call MemInsertIntoFreeBlocks;	/* Put the new block back into the free blocks */
+		mov esi, edi;	/* Restore block */
+		jmp $rDone;
+$rPad:	add eax, ecx;	/* Accumulate leftover padding into block, encoding usage in bit 0 */
+		or eax, MEM_USED;
+		mov [esi]._Size, eax;
+$rDone:	lea eax, [esi]._DATA;	/* Load pointer to resized memory as return value */
+		ret;/* Return to caller */
+$rMove:	push esi;	/* Save old block */
+		push 0;	/* Load arguments */
+		push [esp+16];
+		call MemAlloc;	/* Allocate new block */
+		add esp, 8;	/* Remove arguments from stack */
+		pop esi;/* Restore old block */
+		test eax, eax;	/* If allocation failed, leave old block intact and return NULL */
+		jz $rRet;
+		lea edi, [eax-BLOCK_SIZE];	/* Carry pattern over to new block */
+		mov edx, [esi]._pFree;
+		mov [edi]._pFree, edx;
+		mov edx, [esi]._nFree;
+		mov [edi]._nFree, edx;
+		mov ecx, [esi]._Size;	/* Copy old contents over in dwords; only growth relocates */
+		and ecx, not MEM_USED;
+		shr ecx, 2;
+		add esi, BLOCK_SIZE;
+		mov edi, eax;
+		cld;
+		rep movsd;
+		push eax;	/* Save new memory */
+		push [esp+8];	/* Release old block */
+		call MemFree;
+		add esp, 4;	/* Remove argument from stack */
+		pop eax;/* Restore new memory as return value */
+$rRet:	ret;/* Return to caller */
+$rNew:	push 0;	/* Load arguments */
+		push [esp+12];
+		call MemAlloc;	/* Allocate block */
+		add esp, 8;	/* Remove arguments from stack */
+		ret;/* Return to caller */
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocAligned									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size at a given alignment
+// Input:	Block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemAllocAligned (Dword numBytes, Dword Alignment, FLAGS Options)
+{
+	ptMEMBLOCK Front, MemBlock;	// Block giving up its leading slack, and aligned block
+
+	Pbyte Data, Aligned;// Unaligned and aligned data
+
+	if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0)	// Ascertain that alignment is a power of two
+		return NULL;
+
+	if (Alignment <= MEM_GRAIN)	// Every block meets the granularity
+		return MemAlloc (numBytes, Options);
+
+	Data = (Pbyte) MemAlloc (MEM_ROUND(numBytes) + Alignment + BLOCK_SIZE, 0);	// Leave room for slack on either side
+
+	if (Data == NULL)	// Ascertain that MemAlloc succeeded
+		return NULL;
+
+	Aligned = Data + ((0 - (Dword) Data) & (Alignment - 1));// First aligned address at or past data
+
+	if (Aligned != Data)// Free the leading slack
+	{
+		while ((Dword)(Aligned - Data) < BLOCK_SIZE + MEM_GRAIN)	// Slack must be able to form a block plus data
+			Aligned += Alignment;
+
+		Front = (ptMEMBLOCK) Data - BASE_EXTENT;// Refer to both blocks
+		MemBlock = (ptMEMBLOCK) Aligned - BASE_EXTENT;
+
+		MemBlock->Size = ((Front->Size ^ MEM_USED) - (Dword)(Aligned - Data)) | MEM_USED;	// Aligned block keeps the remainder
+		MemBlock->Prev = Front;	// Update the blocks' connections
+		MemBlock->Next = Front->Next;
+		MemBlock->Next->Prev = MemBlock;
+		Front->Next = MemBlock;
+
+		Front->Size = (Dword)(Aligned - Data) - BLOCK_SIZE;	// Set the slack's size
+
+		_asm {
+			mov esi, Front;	/* Put the slack back into the free blocks */
+			call MemInsertIntoFreeBlocks;
+		}
+
+		MemBlock->Pattern [0] = '\0';	// Effectively zero out block's pattern
+	}
+
+	MemRealloc (Aligned, numBytes);	// Free the trailing slack; shrinking stays in place
+
+	if (Options & MEM_ZERO)	// If requested, zero out the block's memory
+		memset (Aligned, 0, numBytes);
+
+	return Aligned;
+	// Return pointer to allocated memory
+}
+
+/********************************************************************************
+*																				*
+*								MemAllocBatch									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate several blocks of one size at once
+// Input:	Count of blocks, block size, array to load, and options
+// Return:	Count of blocks allocated, which falls short of the count only if memory runs out
+
+Dword MemAllocBatch (Dword Count, Dword numBytes, void * Blocks [], FLAGS Options)
+{
+	Dword nTaken = 0;	// Count of blocks allocated
+
+	while (nTaken < Count && (Blocks [nTaken] = MemAlloc (numBytes, Options)) != NULL)
+		++nTaken;	// The naked path carves a block at a time
+
+	return nTaken;
+	// Return count of blocks allocated
+}
+
+/********************************************************************************
+*																				*
+*								MemFreeBatch									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release several blocks at once
+// Input:	Contexts to release, which are left sorted by address, and their count; NULL entries are skipped
+// Return:	No return value
+
+void MemFreeBatch (void * Blocks [], Dword Count)
+{
+	Dword index;// Loop variable
+
+	qsort (Blocks, Count, sizeof(void *), MemCompareAddresses);	// Release in address order, so each block adjoins the last
+
+	for (index = 0; index < Count; ++index)
+		if (Blocks [index] != NULL) MemFree (Blocks [index]);
+}
+
+/********************************************************************************
+*																				*
+*								MemThreadTerm									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Returns the calling thread's cached blocks to a thread-safe manager
+// Input:	No input
+// Return:	No return value
+
+void MemThreadTerm (void)
+{
+	/* The naked path has no thread caches */
+}
+
+/********************************************************************************
+*																				*
+*								MemCompact										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to coalesce a heap's deferred blocks into its free blocks
+// Input:	A heap handle, or NULL for the global manager
+// Return:	A code indicating the results of the compaction
+
+RETCODE MemCompact (hHEAP Heap)
+{
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	return Heap->Pool != NULL ? RETCODE_SUCCESS : RETCODE_FAILURE;
+	// The naked path coalesces every release at once
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapCreate									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Creates an independent heap
+// Input:	Pointer to a configuration structure
+// Return:	A handle to the new heap, if successful; NULL otherwise
+
+hHEAP MemHeapCreate (puMCONFIG Config)
+{
+	return NULL;
+	// The naked path only manages the global heap
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapDestroy									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Destroys a heap, along with everything allocated from it
+// Input:	A heap handle
+// Return:	A code indicating the results of the destruction
+
+RETCODE MemHeapDestroy (hHEAP Heap)
+{
+	return RETCODE_FAILURE;
+	// The naked path only manages the global heap
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapAlloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size from a heap
+// Input:	A heap handle, block size, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemHeapAlloc (hHEAP Heap, Dword numBytes, FLAGS Options)
+{
+	return NULL;
+	// The naked path only manages the global heap
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapFree										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release memory to a heap
+// Input:	A heap handle, and context to release
+// Return:	No return value
+
+void MemHeapFree (hHEAP Heap, void * memory)
+{
+	/* The naked path only manages the global heap */
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapRealloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to resize memory from a heap, in place where the heap allows
+// Input:	A heap handle, context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * MemHeapRealloc (hHEAP Heap, void * memory, Dword numBytes)
+{
+	return NULL;
+	// The naked path only manages the global heap
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapAllocAligned								*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to allocate memory of a given size at a given alignment from a heap
+// Input:	A heap handle, block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemHeapAllocAligned (hHEAP Heap, Dword numBytes, Dword Alignment, FLAGS Options)
+{
+	return NULL;
+	// The naked path only manages the global heap
+}
+
+/********************************************************************************
+*																				*
+*								MemTraceStart									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Begins recording the global manager's operations to a trace file
+// Input:	Name of the trace file
+// Return:	A code indicating the results of starting the trace
+
+RETCODE MemTraceStart (char const * TraceFile)
+{
+	return RETCODE_FAILURE;
+	// The naked path does not trace
+}
+
+/********************************************************************************
+*																				*
+*								MemTraceStop									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Ends recording the global manager's operations
+// Input:	No input
+// Return:	A code indicating the results of ending the trace
+
+RETCODE MemTraceStop (void)
+{
+	return RETCODE_FAILURE;
+	// The naked path does not trace
+}
+
+#endif // MEM_PORTABLE
+
+/********************************************************************************
+*																				*
+*								MemGetStats										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to take a snapshot of a heap's statistics
+// Input:	A heap handle, or NULL for the global manager, and structure to load
+// Return:	A code indicating the results of taking the snapshot
+
+RETCODE MemGetStats (hHEAP Heap, puMSTATS Stats)
+{
+	ptMEMBLOCK MemBlock;// Block used to find the largest free block
+#ifdef MEM_PORTABLE
+	ptMEMCACHE Cache;	// Thread cache being totaled
+#endif
+
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	if (Heap->Pool == NULL)	// Ascertain that the heap is live
+		return RETCODE_FAILURE;
+
+	ZeroMemory(Stats,sizeof(uMSTATS));	// Clear untracked statistics
+
+#ifdef MEM_PORTABLE
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+	Stats->BytesUsed = MemUsedBytes (Heap);	// Load tracked statistics
+	Stats->PeakBytes = Heap->PeakBytes;
+	Stats->FreeBytes = Heap->FreeBytes;
+	Stats->PoolBytes = Heap->PoolBytes;
+
+	if (Heap->nSearches != 0)	// Average scan lengths
+		Stats->ScanLength = (double) Heap->nSteps / (double) Heap->nSearches;
+
+	memcpy (Stats->Histogram, Heap->Histogram, sizeof(Stats->Histogram));
+
+	if (Heap->BinMap != 0)	// The largest free block lies in the highest non-empty bin
+	{
+		ptMEMBLOCK Base = Heap->Bins [MemHighBit(Heap->BinMap)];// Refer to bin base
+
+		MemBlock = Base;
+
+		do {
+			if (MemBlock->Size > Stats->LargestFree) Stats->LargestFree = MemBlock->Size;
+
+			MemBlock = MemBlock->nFree;
+		} while (MemBlock != Base);
+	}
+#else
+	MemBlock = Heap->Pool;	// Without counters, walk the pool
+
+	do {
+		Dword Size = MemBlock->Size & ~(Dword) MEM_USED;// Size of block
+
+		if (MemBlock->Size & MEM_USED) Stats->BytesUsed += Size;
+
+		else
+		{
+			Stats->FreeBytes += Size;
+
+			if (Size > Stats->LargestFree) Stats->LargestFree = Size;
+		}
+
+		Stats->PoolBytes += Size + BLOCK_SIZE;
+
+		MemBlock = MemBlock->Next;	// Go to next block in memory chain
+	} while (MemBlock != Heap->Pool);
+#endif
+
+	Stats->nUsed = Heap->nUsed;	// Load block counts
+	Stats->nFree = Heap->nUnused;
+
+#ifdef MEM_PORTABLE
+	Stats->nUsed += Heap->nDirect;	// Mapped blocks are used, though outside the pool
+
+	Stats->nDeferred = Heap->nQuick;// Deferred blocks were released, though not yet coalesced
+	Stats->DeferredBytes = Heap->QuickBytes;
+
+	Stats->nUsed -= Stats->nDeferred;
+	Stats->nFree += Stats->nDeferred;
+	Stats->FreeBytes += Stats->DeferredBytes;
+
+	for (Cache = Heap == &MemMgr ? MemMgr.Caches : NULL; Cache != NULL; Cache = Cache->Next)	// Cached blocks are released, though held by their threads
+	{
+		Stats->nCached += MemPeek(&Cache->nBlocks);
+		Stats->CachedBytes += MemPeek(&Cache->Bytes);
+	}
+
+	Stats->nUsed -= Stats->nCached;
+	Stats->BytesUsed -= Stats->CachedBytes;
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+	if (Stats->FreeBytes != 0)	// Measure how much free memory is unusable for the largest requests
+		Stats->Fragmentation = 1.0 - (double) Stats->LargestFree / (double) Stats->FreeBytes;
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemVerify										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to validate a heap's links, free rings and block counts
+// Input:	A heap handle, or NULL for the global manager
+// Return:	A code indicating whether the heap is intact
+
+RETCODE MemVerify (hHEAP Heap)
+{
+	ptMEMBLOCK MemBlock, Base;	// Block being examined, and bin base
+
+	Dword nBlocks, nUsed = 0, nFree = 0, nSeen = 0, nRing = 0, FreeBytes = 0, QuickBytes = 0, Bin;	// Expected and counted blocks and bytes, and loop variable
+
+	BOOL bDamaged = FALSE;	// Whether an invariant was broken
+
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	if (Heap->Pool == NULL)	// Ascertain that the heap is live
+		return RETCODE_FAILURE;
+
+#ifdef MEM_PORTABLE
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+	nBlocks = Heap->nUsed + Heap->nUnused + 2 * Heap->nSegments;// Fences are blocks of the chain as well
+#else
+	nBlocks = Heap->nUsed + Heap->nUnused;
+#endif
+
+	MemBlock = Heap->Pool;	// Walk the physical chain, stopping at the expected count in case it is cut
+
+	do {
+		ptMEMBLOCK Next = MemBlock->Next;	// Physical successor
+
+		Dword Size = MemBlock->Size & ~(Dword) MEM_USED;// Size of block
+
+		if (++nSeen > nBlocks || Next->Prev != MemBlock)	// Neighbours must link back
+		{
+			bDamaged = TRUE;
+
+			break;
+		}
+
+		if (!(MemBlock->Size & MEM_USED))	// Free blocks must not adjoin, or they would have been merged
+		{
+			if (Next > MemBlock && !(Next->Size & MEM_USED))
+			{
+				bDamaged = TRUE;
+
+				break;
+			}
+
+			++nFree;
+
+			FreeBytes += Size;
+		}
+
+		else if (!(MemBlock->Size & MEM_FENCE)) ++nUsed;
+
+		if (Next > MemBlock && !((MemBlock->Size | Next->Size) & MEM_FENCE) && (Pbyte) Next != (Pbyte) &MemBlock [BASE_EXTENT] + Size)
+		{
+			bDamaged = TRUE;// Data must end at the next header
+
+			break;
+		}
+
+		MemBlock = Next;// Go to next block in memory chain
+	} while (MemBlock != Heap->Pool);
+
+	for (Bin = 0; Bin < NUM_BINS && !bDamaged; ++Bin)	// Walk the free rings
+	{
+		Base = Heap->Bins [Bin];
+
+		if ((Base != NULL) != (MEM_BINBIT(Heap, Bin) != 0))	// Bin map must match bins
+		{
+			bDamaged = TRUE;
+
+			break;
+		}
+
+		if (Base == NULL) continue;
+
+		MemBlock = Base;
+
+		do {
+			if (++nRing > Heap->nUnused || (MemBlock->Size & MEM_USED) || MemBlock->nFree->pFree != MemBlock)
+			{
+				bDamaged = TRUE;// Rings must hold free blocks, linked both ways, and no more than are counted
+
+				break;
+			}
+
+#ifdef MEM_PORTABLE
+			if (MemBinIndex (MemBlock->Size) != Bin)// Blocks must lie in their own bin
+			{
+				bDamaged = TRUE;
+
+				break;
+			}
+#endif
+
+			MemBlock = MemBlock->nFree;
+		} while (MemBlock != Base);
+	}
+
+	if (nSeen != nBlocks || nUsed != Heap->nUsed || nFree != Heap->nUnused || nRing != Heap->nUnused)
+		bDamaged = TRUE;// Counts must agree with the manager
+
+#ifdef MEM_PORTABLE
+	if (FreeBytes != Heap->FreeBytes)
+		bDamaged = TRUE;
+
+	nSeen = 0;	// Mapped blocks must be linked both ways, marked, and counted
+
+	for (MemBlock = Heap->Direct; MemBlock != NULL && !bDamaged; MemBlock = MemBlock->Next)
+		if (++nSeen > Heap->nDirect || (MemBlock->Size & MEM_DIRECT) != MEM_DIRECT || (MemBlock->Next != NULL && MemBlock->Next->Prev != MemBlock))
+			bDamaged = TRUE;
+
+	if (nSeen != Heap->nDirect)
+		bDamaged = TRUE;
+
+	nSeen = 0;	// Deferred blocks must be used, listed by their own size, and counted
+
+	for (Bin = 0; Bin < SMALL_BINS && !bDamaged; ++Bin)
+		for (MemBlock = Heap->Quick [Bin]; MemBlock != NULL && !bDamaged; MemBlock = MemBlock->pFree)
+		{
+			if (++nSeen > Heap->nQuick || (MemBlock->Size & MEM_DIRECT) != MEM_USED || (MemBlock->Size ^ MEM_USED) / MEM_GRAIN != Bin)
+				bDamaged = TRUE;
+
+			QuickBytes += MemBlock->Size ^ MEM_USED;
+		}
+
+	if (nSeen != Heap->nQuick || QuickBytes != Heap->QuickBytes)
+		bDamaged = TRUE;
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+	return bDamaged ? RETCODE_FAILURE : RETCODE_SUCCESS;
+	// Return result of verification
+}
+
+/********************************************************************************
+*																				*
+*								MemExportMap									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to write the address, size and state of every block in a heap, in address-chain order
+// Input:	A heap handle, or NULL for the global manager, name of the map file, and options
+// Return:	A code indicating the results of writing the map
+
+RETCODE MemExportMap (hHEAP Heap, char const * MapFile, FLAGS Options)
+{
+	PRIVATE char const * States [] = { "used", "free", "fence", "held", "direct", "deferred" };	// Names of block states
+
+	puMMAPENTRY Entries, Entry;	// Snapshot of blocks, and record being loaded
+
+	ptMEMBLOCK MemBlock;// Block being recorded
+
+	FILE * fpMap;	// File receiving the map
+
+	Dword nEntries = 0, nBlocks, nMapped = 0, nSeen = 0, index;	// Snapshot capacity, expected chained and mapped blocks, recorded blocks, and loop variable
+
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	if (Heap->Pool == NULL)	// Ascertain that the heap is live
+		return RETCODE_FAILURE;
+
+	for (Entries = NULL; ; )// Size the snapshot outside the lock, where calloc may come back to the heap; retry if the heap outgrew it
+	{
+#ifdef MEM_PORTABLE
+		if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+		nBlocks = Heap->nUsed + Heap->nUnused + 2 * Heap->nSegments;
+		nMapped = Heap->nDirect;
+#else
+		nBlocks = Heap->nUsed + Heap->nUnused;
+#endif
+
+		if (Entries != NULL && nEntries >= nBlocks + nMapped)	// Snapshot fits; keep the lock
+			break;
+
+#ifdef MEM_PORTABLE
+		if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+		free (Entries);
+
+		nEntries = nBlocks + nMapped + 1;
+
+		Entries = (puMMAPENTRY) calloc (nEntries, sizeof(uMMAPENTRY));	// Snapshot lives outside the pool
+
+		if (Entries == NULL)// Ascertain that calloc succeeded
+			return RETCODE_FAILURE;
+	}
+
+#ifdef MEM_PORTABLE
+	MemFlipDeferred (Heap);	// Tell deferred blocks apart from used ones while the chain is walked
+#endif
+
+	MemBlock = Heap->Pool;	// Refer to first memory block
+
+	do {
+		Entry = &Entries [nSeen++];	// Load record
+
+		Entry->Address = (size_t) MemBlock;
+		Entry->Size = MemBlock->Size & MEM_FENCE ? 0 : MemBlock->Size & ~(Dword) MEM_USED;
+		Entry->State = MemBlock->Size & MEM_FENCE ? MEM_BLOCK_FENCE : MemBlock->Size & MEM_USED ? MEM_BLOCK_USED : MEM_BLOCK_FREE;
+
+#ifdef MEM_PORTABLE
+		if (Entry->State == MEM_BLOCK_USED && MemIsHeld (Heap, MemBlock))	// Tell quarantined blocks apart
+			Entry->State = MEM_BLOCK_HELD;
+
+		if ((MemBlock->Size & MEM_DIRECT) == MEM_DEFERRED)	// Tell deferred blocks apart
+		{
+			Entry->Size = MemBlock->Size ^ MEM_DEFERRED;
+			Entry->State = MEM_BLOCK_DEFER;
+		}
+#endif
+
+		MemBlock = MemBlock->Next;	// Go to next block in memory chain
+	} while (MemBlock != Heap->Pool && nSeen < nBlocks);	// Cut a damaged chain off at the expected count
+
+#ifdef MEM_PORTABLE
+	for (MemBlock = Heap->Direct, index = 0; MemBlock != NULL && index < nMapped; MemBlock = MemBlock->Next, ++index)
+	{
+		Entry = &Entries [nSeen++];	// Record mapped blocks after the chain
+
+		Entry->Address = (size_t) MemBlock;
+		Entry->Size = MemBlock->Size & ~(Dword) MEM_DIRECT;
+		Entry->State = MEM_BLOCK_DIRECT;
+	}
+
+	MemFlipDeferred (Heap);	// Restore deferred blocks as used
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+	fpMap = fopen (MapFile, Options & MEM_MAP_CSV ? "wt" : "wb");	// Write the map outside the lock, where stdio may come back to the heap
+
+	if (fpMap == NULL)	// Ascertain that fopen succeeded
+	{
+		free (Entries);
+
+		return RETCODE_FAILURE;
+	}
+
+	if (Options & MEM_MAP_CSV)	// Write text records
+	{
+		fprintf (fpMap, "address,size,state\n");
+
+		for (index = 0; index < nSeen; ++index)
+			fprintf (fpMap, "0x%llx,%lu,%s\n", Entries [index].Address, (unsigned long) Entries [index].Size, States [Entries [index].State]);
+	}
+
+	else fwrite (Entries, sizeof(uMMAPENTRY), nSeen, fpMap);
+
+	fclose (fpMap);
+
+	free (Entries);
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemGetSites										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to total a heap's used blocks by allocation site or pattern, largest footprint first
+// Input:	A heap handle, or NULL for the global manager, array to load, and its capacity
+// Return:	Count of distinct sites, which may exceed the capacity
+
+Dword MemGetSites (hHEAP Heap, puMSITE Sites, Dword nSites)
+{
+	puMSITE Table;	// Sites found, keyed in place by their Site field
+
+	ptMEMBLOCK MemBlock;// Block being totaled
+
+	Dword Mask = 0, nFound = 0, nBlocks, nSeen = 0, slot;	// Table capacity, then capacity less one, count of sites, expected and seen blocks, and table slot
+
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	if (Heap->Pool == NULL)	// Ascertain that the heap is live
+		return 0;
+
+	for (Table = NULL; ; )	// Size the table outside the lock, where calloc may come back to the heap; retry if the heap outgrew it
+	{
+#ifdef MEM_PORTABLE
+		if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+		nBlocks = Heap->nUsed + Heap->nDirect;
+#else
+		nBlocks = Heap->nUsed;
+#endif
+
+		if (Table != NULL && Mask >= nBlocks * 2)	// Table fits; keep the lock
+			break;
+
+#ifdef MEM_PORTABLE
+		if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+		free (Table);
+
+		for (Mask = 0x10; Mask < nBlocks * 2; Mask <<= 1);
+
+		Table = (puMSITE) calloc (Mask, sizeof(uMSITE));// Table lives outside the pool
+
+		if (Table == NULL)	// Ascertain that calloc succeeded
+			return 0;
+	}
+
+	--Mask;
+
+#ifdef MEM_PORTABLE
+	MemFlipDeferred (Heap);	// Deferred blocks were released, so mark them out of the tally
+
+	nBlocks = Heap->nUsed + Heap->nUnused + 2 * Heap->nSegments;
+#else
+	nBlocks = Heap->nUsed + Heap->nUnused;
+#endif
+
+	MemBlock = Heap->Pool;	// Total used blocks by key
+
+	do {
+		if ((MemBlock->Size & (MEM_USED | MEM_FENCE)) == MEM_USED)	// Skip free, deferred and fence blocks
+		{
+#ifdef MEM_PORTABLE
+			if (!MemIsHeld (Heap, MemBlock))// Quarantined blocks were released
+#endif
+				MemTallySite (Table, Mask, MemBlock, MemBlock->Size ^ MEM_USED);
+		}
+
+		MemBlock = MemBlock->Next;	// Go to next block in memory chain
+	} while (MemBlock != Heap->Pool && ++nSeen < nBlocks);
+
+#ifdef MEM_PORTABLE
+	for (MemBlock = Heap->Direct; MemBlock != NULL; MemBlock = MemBlock->Next)	// Total mapped blocks as well
+		MemTallySite (Table, Mask, MemBlock, MemBlock->Size & ~(Dword) MEM_DIRECT);
+
+	MemFlipDeferred (Heap);	// Restore deferred blocks as used
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+#endif
+
+	for (slot = 0; slot <= Mask; ++slot)// Gather sites, then order them by footprint
+		if (Table [slot].Count != 0) Table [nFound++] = Table [slot];
+
+	qsort (Table, nFound, sizeof(uMSITE), MemCompareSites);
+
+	for (slot = 0; slot < nFound && slot < nSites; ++slot)	// Load sites, splitting keys into addresses and patterns
+	{
+		unsigned long long Key = Table [slot].Site;	// Site's key
+
+		Sites [slot] = Table [slot];
+
+		Sites [slot].Site = Key & SITE_BIT ? Key & ~SITE_BIT : 0;
+
+		if (!(Key & SITE_BIT)) memcpy (Sites [slot].Tag, &Key, 8);
+	}
+
+	free (Table);
+
+	return nFound;
+	// Return count of sites
+}
+
+/********************************************************************************
+*																				*
+*								MemGetPattern									*
+*																				*
+********************************************************************************/
+
+// Purpose:	Used to retrieve a pattern used to identify memory
+// Input:   Memory variable associated with pattern, and a buffer to load
+// Return:  A code indicating the results of getting the pattern
+
+RETCODE MemGetPattern (void * memory, char Pattern [])
+{
+	ptMEMBLOCK MemBlock;// Owner memory block
+
+	int index;	// Loop variable
+
+	MemBlock = (ptMEMBLOCK)((Pbyte) memory - sizeof(tMEMBLOCK));
+	// Refer to memory's owning block
+
+	if (MemSiteKey (MemBlock) & SITE_BIT)	// A recorded site is no pattern
+	{
+		Pattern [0] = '\0';
+
+		return RETCODE_SUCCESS;
+	}
+
+	for (index = 0; index < 8; ++index)	// Loop through pattern
+	{
+		Pattern [index] = MemBlock->Pattern [index];// Get byte
+
+		if (MemBlock->Pattern [index] == '\0')	// Check for null bytes
+			break;	// Pattern is complete
+	}
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemSetPattern									*
+*																				*
+********************************************************************************/
+
+// Purpose:	Used to associate a pattern to a memory variable
+// Input:   Memory variable to associate with pattern, and pattern to assign
+// Return:  A code indicating the results of setting the pattern
+
+RETCODE MemSetPattern (void * memory, char Pattern [])
+{
+	return MemHeapSetPattern (&MemMgr, memory, Pattern);
+	// Label memory of the global manager
+}
+
+/********************************************************************************
+*																				*
+*								MemHeapSetPattern								*
+*																				*
+********************************************************************************/
+
+// Purpose:	Used to associate a pattern to memory from a heap, under the heap's lock
+// Input:	A heap handle, or NULL for the global manager, memory variable to associate with pattern, and pattern to assign
+// Return:	A code indicating the results of setting the pattern
+
+RETCODE MemHeapSetPattern (hHEAP Heap, void * memory, char Pattern [])
+{
+	ptMEMBLOCK MemBlock;// Owner memory block
+
+	char Text [sizeof(MemBlock->Pattern)];	// Pattern, padded with null bytes, which clear any recorded site
+
+	int index;	// Loop variable
+
+	if (Heap == NULL)	// Default to the global manager
+		Heap = &MemMgr;
+
+	MemBlock = (ptMEMBLOCK)((Pbyte) memory - sizeof(tMEMBLOCK));
+	// Refer to memory's owning block
+
+	memset (Text, 0, sizeof(Text));
+
+	for (index = 0; index < 8; ++index)	// Loop through pattern
+	{
+		Text [index] = Pattern [index];	// Set byte
+
+		if (Text [index] == '\0')	// Check for null bytes
+			break;	// Pattern is complete
+	}
+
+#ifdef MEM_PORTABLE
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);	// MemGetSites reads patterns under the owning heap's lock
+#endif
+
+	memcpy (MemBlock->Pattern, Text, sizeof(MemBlock->Pattern));
+
+#ifdef MEM_PORTABLE
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+	if (Heap == &MemMgr && MEM_TRACING())	// Record labeling of the global manager's memory
+	{
+		unsigned long long Bytes = 0;	// Pattern bytes
+
+		memcpy (&Bytes, Text, index < 8 ? index : 8);
+
+		MemTraceRecord (MEM_TRACE_PATTERN, 0, 0, 0, memory, Bytes);
+	}
+#endif
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+#ifdef MEM_PORTABLE
+
+/********************************************************************************
+*																				*
+*								MemHeapSetup									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to load a heap's settings and free its initial pool
+// Input:	Heap with linked pool, and pointer to a configuration structure
+// Return:	No return value
+
+void MemHeapSetup (pmMEMORY Heap, puMCONFIG Config)
+{
+	Heap->Settings = Config->Settings;	// Load settings and per-class cache depth
+	Heap->CacheDepth = Config->CacheDepth != 0 ? Config->CacheDepth : CACHE_DEPTH;
+
+	Heap->PoolBytes = MEM_ROUND(Config->PoolSize);	// Load growth parameters
+	Heap->PoolLimit = Config->PoolLimit;
+	Heap->GrowthRate = Config->GrowthRate != 0 ? Config->GrowthRate : GROWTH_RATE;
+
+	Heap->Placement = Config->Placement;// Load placement policy
+	Heap->MapThreshold = Config->MapThreshold;
+
+	Heap->Clean = (Pbyte) &Heap->Pool [BASE_EXTENT];// The pool is fresh, so all of it is zero
+	Heap->CleanEnd = Heap->Clean + Heap->Pool->Size;
+
+	MemInsertIntoFreeBlocks (Heap, Heap->Pool);	// Initialize the memory pool
+
+	if (Heap->Settings & MEM_THREADSAFE)// Prepare lock for shared use
+		MemLockInit(&Heap->Lock);
+}
+
+/********************************************************************************
+*																				*
+*								MemTakeBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to carve a used block out of the free blocks, or to reuse a deferred block of the same size, stamping it with a key while the lock is held
+// Input:	Heap, size of request, rounded to allocation granularity, and key
+// Return:	Used block, if successful; NULL otherwise
+
+ptMEMBLOCK MemTakeBlock (pmMEMORY Heap, Dword Size, unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock;// Block to carve allocation from
+
+	if (Size < SMALL_LIMIT && Heap->Quick [Size / MEM_GRAIN] != NULL)	// Reuse a deferred block as it stands
+	{
+		MemBlock = Heap->Quick [Size / MEM_GRAIN];	// Pop block from its list
+		Heap->Quick [Size / MEM_GRAIN] = MemBlock->pFree;
+
+		--Heap->nQuick;	// Document reuse of deferred block
+		Heap->QuickBytes -= Size;
+
+		++Heap->Histogram [MemBinIndex (Size)];
+
+		Heap->Stale = (Pbyte) &MemBlock [BASE_EXTENT] + Size;	// Block was used, so all of it may be non-zero
+
+		if (MemUsedBytes (Heap) > Heap->PeakBytes)	// Document new peak usage
+			Heap->PeakBytes = MemUsedBytes (Heap);
+
+		MemSetKey (MemBlock, Key);	// Stamp block before anyone can look at it
+
+		return MemBlock;
+	}
+
+	MemBlock = MemFindBlock (Heap, Size);
+
+	if (MemBlock == NULL && Heap->nQuick != 0)	// If no blocks were found, coalesce deferred blocks and look again
+	{
+		MemCompactHeap (Heap);
+
+		MemBlock = MemFindBlock (Heap, Size);
+	}
+
+	if (MemBlock == NULL)	// If no blocks were found, try to grow the pool
+	{
+		if (MemGrowPool (Heap, Size) != RETCODE_SUCCESS)
+			return NULL;
+
+		MemBlock = MemFindBlock (Heap, Size);
+	}
+
+	MemRemoveFromFreeBlocks (Heap, MemBlock);	// Extract the memory block from the pool
+
+	++Heap->nUsed;	// Document addition of used memory block
+	++Heap->Histogram [MemBinIndex (Size)];
+
+	MemSplitBlock (Heap, MemBlock, Size);	// Return any padding to the pool
+
+	MemSetKey (MemBlock, Key);	// Stamp block before anyone can look at it
+
+	return MemBlock;
+	// Return carved block
+}
+
+/********************************************************************************
+*																				*
+*								MemSplitBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to mark a block used, splitting off any padding past a request as a free block
+// Input:	Heap, block outside the free blocks, and size of request, rounded to allocation granularity
+// Return:	No return value
+
+void MemSplitBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Size)
+{
+	Dword Padding = (MemBlock->Size & ~(Dword) MEM_USED) - Size;// Compute the padding left over
+
+	if (Padding > BLOCK_SIZE)	// If padding is adequate to form a new block plus data, split it off
+	{
+		ptMEMBLOCK Split = (ptMEMBLOCK)((Pbyte) &MemBlock [BASE_EXTENT] + Size);// Refer to new block
+
+		Split->Size = Padding - BLOCK_SIZE;	// Set the new block's size
+		Split->Prev = MemBlock;	// Update the blocks' connections
+		Split->Next = MemBlock->Next;
+		Split->Next->Prev = Split;
+		MemBlock->Next = Split;
+
+		MemBlock->Size = Size | MEM_USED;	// Encode usage in bit 0
+
+		MemInsertIntoFreeBlocks (Heap, Split);// Put the new block back into the free blocks
+	}
+
+	else MemBlock->Size |= MEM_USED;// Accumulate leftover padding into allocated block
+
+	MemTouchBlock (Heap, MemBlock);	// Note which of the block's bytes were never used
+
+	if (MemUsedBytes (Heap) > Heap->PeakBytes)	// Document new peak usage
+		Heap->PeakBytes = MemUsedBytes (Heap);
+}
+
+/********************************************************************************
+*																				*
+*								MemSplitBatch									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to carve one block for a batch and divide it into used blocks of one size, each stamped with a key
+// Input:	Heap, size of each request, rounded to allocation granularity, count of blocks, array to load, and key
+// Return:	A code indicating whether the batch was carved
+
+RETCODE MemSplitBatch (pmMEMORY Heap, Dword Size, Dword Count, void * Blocks [], unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock, Next;	// Block being divided, and block following the batch
+
+	Dword Rest, index;	// Bytes not yet divided, of which the last block keeps any padding, and loop variable
+
+	Heap->nUsed += Count - 1;	// Document the batch's other headers before the carve, so its peak counts data bytes alone
+
+	MemBlock = MemTakeBlock (Heap, (Size + BLOCK_SIZE) * Count - BLOCK_SIZE, Key);
+
+	if (MemBlock == NULL)	// Without a block large enough, the headers are not spent
+	{
+		Heap->nUsed -= Count - 1;
+
+		return RETCODE_FAILURE;
+	}
+
+	Next = MemBlock->Next;
+	Rest = MemBlock->Size ^ MEM_USED;
+
+	--Heap->Histogram [MemBinIndex (Size + (Count - 1) * (Size + BLOCK_SIZE))];	// Count the batch as its requests
+	Heap->Histogram [MemBinIndex (Size)] += Count;
+
+	for (index = 0; index < Count - 1; ++index)	// Lay blocks out back to back
+	{
+		ptMEMBLOCK Split = (ptMEMBLOCK)((Pbyte) &MemBlock [BASE_EXTENT] + Size);// Refer to next block
+
+		Split->Prev = MemBlock;	// Update the blocks' connections
+		MemBlock->Next = Split;
+
+		MemBlock->Size = Size | MEM_USED;	// Encode usage in bit 0
+
+		Blocks [index] = &MemBlock [BASE_EXTENT];
+
+		Rest -= Size + BLOCK_SIZE;
+		MemBlock = Split;
+
+		MemSetKey (MemBlock, Key);	// Stamp next block; the first was stamped when carved
+	}
+
+	MemBlock->Size = Rest | MEM_USED;	// Close the batch off
+	MemBlock->Next = Next;
+	Next->Prev = MemBlock;
+
+	Blocks [Count - 1] = &MemBlock [BASE_EXTENT];
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemTouchBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to record how much of a used block may be non-zero, and to move never-used memory past it
+// Input:	Heap, and used block
+// Return:	No return value
+
+void MemTouchBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	Pbyte Data = (Pbyte) &MemBlock [BASE_EXTENT];	// Block's data
+	Pbyte End = Data + (MemBlock->Size ^ MEM_USED);	// End of block's data
+
+	if (End + BLOCK_SIZE <= Heap->Clean || Data >= Heap->CleanEnd)	// Blocks outside never-used memory, headers after them included, may be wholly non-zero
+	{
+		Heap->Stale = End;
+
+		return;
+	}
+
+	Heap->Stale = Data > Heap->Clean ? Data : Heap->Clean;	// Data past the never-used mark is zero
+
+	Heap->Clean = End + BLOCK_SIZE < Heap->CleanEnd ? End + BLOCK_SIZE : Heap->CleanEnd;	// Next block's header will be written
+}
+
+/********************************************************************************
+*																				*
+*								MemClearBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to zero out a used block's memory, skipping what is known to be zero
+// Input:	Used block, and end of bytes that may be non-zero, or NULL if unknown
+// Return:	No return value
+
+void MemClearBlock (ptMEMBLOCK MemBlock, Pbyte Stale)
+{
+	Pbyte Data = (Pbyte) &MemBlock [BASE_EXTENT];	// Block's data
+	Pbyte End = Data + (MemBlock->Size ^ MEM_USED);	// End of block's data
+
+	if (Stale == NULL || Stale > End)	// Without knowledge, clear all of the block
+		Stale = End;
+
+	if (Stale > Data)	// Clear bytes that may be non-zero
+		MemZero (Data, Stale - Data);
+}
+
+/********************************************************************************
+*																				*
+*								MemResizeBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to resize a used block in place, absorbing a free successor to grow
+// Input:	Heap, used block to resize, and new size, rounded to allocation granularity
+// Return:	A code indicating whether the block could be resized in place
+
+RETCODE MemResizeBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Size)
+{
+	ptMEMBLOCK Next = MemBlock->Next;	// Physical successor
+
+	Dword Have = MemBlock->Size ^ MEM_USED;	// Current size of block
+
+	if (Have < Size)// Growing requires a free successor upper in memory, large enough to cover the rest
+	{
+		if (Next < MemBlock || (Next->Size & MEM_USED) || Have + BLOCK_SIZE + Next->Size < Size)
+			return RETCODE_FAILURE;
+
+		MemRemoveFromFreeBlocks (Heap, Next);	// Take next block out of its bin
+
+		MemBlock->Size += Next->Size + BLOCK_SIZE;	// Enlarge block by next block
+
+		MemBlock->Next = Next->Next;// Update blocks' connections
+		MemBlock->Next->Prev = MemBlock;
+	}
+
+	MemSplitBlock (Heap, MemBlock, Size);	// Return any excess, whether left by growth or by shrinkage
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemAlignBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to move a used block's data up to an alignment, returning the leading slack as a free block
+// Input:	Heap, used block with room for the alignment, and power-of-two alignment
+// Return:	Aligned used block
+
+ptMEMBLOCK MemAlignBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Alignment)
+{
+	ptMEMBLOCK Front = MemBlock;// Block giving up its leading slack
+
+	Pbyte Data = (Pbyte) &MemBlock [BASE_EXTENT];	// Unaligned data
+	Pbyte Aligned = Data + ((0 - (size_t) Data) & (Alignment - 1));	// First aligned address at or past data
+
+	if (Aligned == Data)// Data is already aligned
+		return MemBlock;
+
+	while ((Dword)(Aligned - Data) < BLOCK_SIZE + MEM_GRAIN)	// Slack must be able to form a block plus data
+		Aligned += Alignment;
+
+	MemBlock = (ptMEMBLOCK) Aligned - BASE_EXTENT;	// Refer to aligned block
+
+	MemBlock->Size = ((Front->Size ^ MEM_USED) - (Dword)(Aligned - Data)) | MEM_USED;	// Aligned block keeps the remainder
+	MemBlock->Prev = Front;	// Update the blocks' connections
+	MemBlock->Next = Front->Next;
+	MemBlock->Next->Prev = MemBlock;
+	Front->Next = MemBlock;
+
+	Front->Size = (Dword)(Aligned - Data) - BLOCK_SIZE;	// Set the slack's size
+
+	MemInsertIntoFreeBlocks (Heap, Front);	// Put the slack back into the free blocks
+
+	return MemBlock;
+	// Return aligned block
+}
+
+/********************************************************************************
+*																				*
+*								MemFindBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to find a free block that fits a request
+// Input:	Heap, and size of request, rounded to allocation granularity
+// Return:	Fitting block, if any; NULL otherwise
+
+ptMEMBLOCK MemFindBlock (pmMEMORY Heap, Dword Size)
+{
+	ptMEMBLOCK MemBlock = NULL;	// Block to carve allocation from
+
+	Dword Bin = MemBinIndex (Size);	// Bin matching the request
+
+	unsigned long long BinMap;	// Remaining bins to search
+
+	++Heap->nSearches;	// Document search
+
+	if (Bin >= SMALL_BINS)	// Blocks in a power-of-two bin may not fit
+	{
+		if (Heap->Bins [Bin] != NULL)	// Scan through the head of bin
+			MemBlock = MemScanBin (Heap, Bin, Size, SCAN_LIMIT);
+
+		++Bin;	// Every block in a higher bin fits
+	}
+
+	if (MemBlock == NULL)	// Take from the first non-empty bin at or above the request's
+	{
+		BinMap = Bin < NUM_BINS ? Heap->BinMap >> Bin : 0;
+
+		if (BinMap == 0)	// With no higher blocks, scan the whole of a straddling bin before giving up
+			return Bin > SMALL_BINS && Heap->Bins [Bin - 1] != NULL ? MemScanBin (Heap, Bin - 1, Size, ~(Dword) 0) : NULL;
+
+		Bin += MemLowBit(BinMap);
+
+		if (Heap->Placement == MEM_BEST_FIT && Bin >= SMALL_BINS)	// Blocks in a power-of-two bin differ in size
+			MemBlock = MemScanBin (Heap, Bin, Size, SCAN_LIMIT);
+
+		else// Take bin base
+		{
+			MemBlock = Heap->Bins [Bin];
+
+			++Heap->nSteps;	// Document examination of bin base
+		}
+	}
+
+	return MemBlock;
+	// Return fitting block
+}
+
+/********************************************************************************
+*																				*
+*								MemScanBin										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to pick a fitting block out of a non-empty bin, according to the placement policy
+// Input:	Heap, bin to scan, size of request, rounded to allocation granularity, and most blocks to examine
+// Return:	Fitting block, if any; NULL otherwise
+
+ptMEMBLOCK MemScanBin (pmMEMORY Heap, Dword Bin, Dword Size, Dword Limit)
+{
+	ptMEMBLOCK Base = Heap->Bins [Bin], MemBlock = Base;// Bin base, and block being examined
+	ptMEMBLOCK Fit = NULL;	// Block chosen so far
+
+	do {
+		++Heap->nSteps;	// Document examination of block
+
+		if (MemBlock->Size >= Size)	// Consider fitting blocks
+		{
+			if (Heap->Placement != MEM_BEST_FIT)// Stop at first fit
+			{
+				Fit = MemBlock;
+
+				break;
+			}
+
+			if (Fit == NULL || MemBlock->Size < Fit->Size)	// Keep smallest fit, stopping at an exact one
+				Fit = MemBlock;
+
+			if (Fit->Size == Size)
+				break;
+		}
+
+		MemBlock = MemBlock->nFree;
+	} while (MemBlock != Base && --Limit != 0);	// Best fit settles for the smallest fit within the limit
+
+	if (Fit != NULL && Heap->Placement == MEM_NEXT_FIT)	// Rove: once the fit is taken, the bin resumes after it
+		Heap->Bins [Bin] = Fit;
+
+	return Fit;
+	// Return fitting block
+}
+
+/********************************************************************************
+*																				*
+*								MemGrowPool										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to chain a new segment onto a heap's pool
+// Input:	Heap, and size of request the segment must satisfy
+// Return:	A code indicating the results of the growth
+
+RETCODE MemGrowPool (pmMEMORY Heap, Dword Size)
+{
+	ptMEMBLOCK Head, MemBlock, Tail;// Segment's fences, and its free block
+
+	Dword Need = Size + 3 * BLOCK_SIZE;	// Smallest segment that satisfies request
+	Dword Bytes = Heap->PoolBytes / 100 * Heap->GrowthRate;	// Size of segment by growth rate
+
+	if (Heap->PoolBytes >= Heap->PoolLimit)	// Ascertain that the pool may still grow
+		return RETCODE_FAILURE;
+
+	if (Bytes < Need) Bytes = Need;	// Grow at least enough for the request, in whole pages
+
+	Bytes = (Bytes + MEM_PAGE - 1) & ~(Dword)(MEM_PAGE - 1);
+
+	if (Bytes > Heap->PoolLimit - Heap->PoolBytes)	// Clamp growth to the ceiling
+	{
+		Bytes = (Heap->PoolLimit - Heap->PoolBytes) & ~(Dword)(MEM_PAGE - 1);
+
+		if (Bytes < Need)	// Ascertain that the clamped segment still fits request
+			return RETCODE_FAILURE;
+	}
+
+	Head = (ptMEMBLOCK) MemMapPages(Bytes);	// Map segment
+
+	if (Head == NULL)	// Ascertain that mapping succeeded
+		return RETCODE_FAILURE;
+
+	MemBlock = Head + BASE_EXTENT;	// Lay out fences around a single free block
+	Tail = (ptMEMBLOCK)((Pbyte) Head + Bytes - BLOCK_SIZE);
+
+	Head->Size = Tail->Size = Bytes | MEM_USED | MEM_FENCE;	// Fences record the segment size
+	MemBlock->Size = (Dword)((Pbyte) Tail - (Pbyte) &MemBlock [BASE_EXTENT]);
+
+	Head->Prev = Heap->Pool->Prev;	// Link segment in at the end of the physical chain
+	Head->Next = MemBlock;
+	MemBlock->Prev = Head;
+	MemBlock->Next = Tail;
+	Tail->Prev = MemBlock;
+	Tail->Next = Heap->Pool;
+	Heap->Pool->Prev->Next = Head;
+	Heap->Pool->Prev = Tail;
+
+	Head->pFree = NULL;	// Link segment into the heap's segment list
+	Head->nFree = Heap->Segments;
+
+	if (Heap->Segments != NULL) Heap->Segments->pFree = Head;
+
+	Heap->Segments = Head;
+
+	Heap->PoolBytes += Bytes;	// Document growth
+	++Heap->nSegments;
+
+	Heap->Clean = (Pbyte) &MemBlock [BASE_EXTENT];	// Mapped pages come zeroed; track the segment's instead of any older memory
+	Heap->CleanEnd = (Pbyte) Tail;
+
+	MemInsertIntoFreeBlocks (Heap, MemBlock);	// Put the new block into the free blocks
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemTrimPool										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to return a segment to the system if a free block spans all of it
+// Input:	Heap, and free block to test
+// Return:	No return value
+
+void MemTrimPool (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	ptMEMBLOCK Head = MemBlock->Prev, Tail = MemBlock->Next;// Neighbours; fences if block spans a segment
+
+	Dword Bytes = Head->Size & ~(Dword)(MEM_USED | MEM_FENCE);	// Segment size recorded in fences
+
+	if (MemBlock == Heap->Pool || !(Head->Size & MEM_FENCE) || Tail->Size != Head->Size)
+		return;	// The initial pool is kept, and other blocks must lie between fences
+
+	if (&Head [BASE_EXTENT] != MemBlock || (Pbyte) Head + Bytes != (Pbyte) &Tail [BASE_EXTENT])
+		return;	// Fences must bound this block within one segment
+
+	MemRemoveFromFreeBlocks (Heap, MemBlock);	// Take block out of its bin
+
+	Head->Prev->Next = Tail->Next;	// Unlink segment from the physical chain
+	Tail->Next->Prev = Head->Prev;
+
+	if (Head->pFree != NULL) Head->pFree->nFree = Head->nFree;	// Unlink segment from the segment list
+	else Heap->Segments = Head->nFree;
+
+	if (Head->nFree != NULL) Head->nFree->pFree = Head->pFree;
+
+	Heap->PoolBytes -= Bytes;	// Document shrinkage
+	--Heap->nSegments;
+
+	if (Heap->CleanEnd == (Pbyte) Tail)	// Forget never-used memory within the segment
+		Heap->Clean = Heap->CleanEnd = NULL;
+
+	MemUnmapPages(Head, Bytes);	// Return segment to the system
+}
+
+/********************************************************************************
+*																				*
+*								MemReleaseSegments								*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to return all of a heap's growth segments to the system
+// Input:	Heap
+// Return:	No return value
+
+void MemReleaseSegments (pmMEMORY Heap)
+{
+	while (Heap->Segments != NULL)	// Unmap segments; blocks are never visited
+	{
+		ptMEMBLOCK Head = Heap->Segments;	// Refer to first segment
+
+		Heap->Segments = Head->nFree;
+
+		Heap->PoolBytes -= Head->Size & ~(Dword)(MEM_USED | MEM_FENCE);	// Document shrinkage
+
+		MemUnmapPages(Head, Head->Size & ~(Dword)(MEM_USED | MEM_FENCE));
+	}
+
+	while (Heap->Direct != NULL)// Unmap mapped blocks as well
+	{
+		ptMEMBLOCK MemBlock = Heap->Direct;	// Refer to first mapped block
+
+		Heap->Direct = MemBlock->Next;
+
+		MemUnmapPages(MAP_BASE(MemBlock), (Pbyte) MemBlock - MAP_BASE(MemBlock) + (MemBlock->Size & ~(Dword) MEM_DIRECT) + BLOCK_SIZE);
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemMapBlock										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to map a used block on pages of its own, outside the pool, stamped with a key before it is linked
+// Input:	Heap, size of request, rounded to allocation granularity, power-of-two alignment, at most a page, and key
+// Return:	Used block, if successful; NULL otherwise
+
+ptMEMBLOCK MemMapBlock (pmMEMORY Heap, Dword Size, Dword Alignment, unsigned long long Key)
+{
+	ptMEMBLOCK MemBlock;// Block heading the mapping
+
+	Pbyte Pages;// Start of the mapping
+
+	Dword Lead = 0;	// Bytes ahead of the header that bring its data onto the alignment
+
+	Dword Bytes;// Lead, header and request, in whole pages
+
+	if (Alignment > MEM_GRAIN)	// Pages meet any alignment up to their own; only the header stands in the way
+		Lead = ((BLOCK_SIZE + Alignment - 1) & ~(Dword)(Alignment - 1)) - BLOCK_SIZE;
+
+	Bytes = (Lead + Size + BLOCK_SIZE + MAP_PAGE - 1) & ~(Dword)(MAP_PAGE - 1);
+
+	if (Bytes < Size)	// Ascertain that the request did not wrap
+		return NULL;
+
+	Pages = (Pbyte) MemMapPages(Bytes);	// Map block outside the lock
+
+	if (Pages == NULL)	// Ascertain that mapping succeeded
+		return NULL;
+
+	MemBlock = (ptMEMBLOCK)(Pages + Lead);	// Header stays on the first page, where MAP_BASE finds the mapping again
+
+	MemBlock->Size = (Bytes - Lead - BLOCK_SIZE) | MEM_DIRECT;	// Block owns the rest of its pages
+
+	MemSetKey (MemBlock, Key);	// Stamp block while it is still private
+
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+	MemBlock->Prev = NULL;	// Link block into the heap's mapped blocks
+	MemBlock->Next = Heap->Direct;
+
+	if (Heap->Direct != NULL) Heap->Direct->Prev = MemBlock;
+
+	Heap->Direct = MemBlock;
+
+	++Heap->nDirect;// Document addition of mapped block
+	Heap->DirectBytes += Bytes - Lead - BLOCK_SIZE;
+
+	++Heap->Histogram [MemBinIndex (Size)];
+
+	if (MemUsedBytes (Heap) > Heap->PeakBytes)	// Document new peak usage
+		Heap->PeakBytes = MemUsedBytes (Heap);
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+	return MemBlock;
+	// Return mapped block
+}
+
+/********************************************************************************
+*																				*
+*								MemUnmapBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to return a mapped block's pages to the system
+// Input:	Heap, and mapped block
+// Return:	No return value
+
+void MemUnmapBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	Dword Size = MemBlock->Size & ~(Dword) MEM_DIRECT;	// Size of block
+
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);
+
+	if (MemBlock->Prev != NULL) MemBlock->Prev->Next = MemBlock->Next;	// Unlink block from the heap's mapped blocks
+	else Heap->Direct = MemBlock->Next;
+
+	if (MemBlock->Next != NULL) MemBlock->Next->Prev = MemBlock->Prev;
+
+	--Heap->nDirect;// Document removal of mapped block
+	Heap->DirectBytes -= Size;
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+	MemUnmapPages(MAP_BASE(MemBlock), (Pbyte) MemBlock - MAP_BASE(MemBlock) + Size + BLOCK_SIZE);	// Return pages to the system outside the lock
+}
+
+/********************************************************************************
+*																				*
+*								MemUsedBytes									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to compute the bytes in a heap's used blocks
+// Input:	Heap
+// Return:	Bytes in used blocks, headers excluded
+
+Dword MemUsedBytes (pmMEMORY Heap)
+{
+	return Heap->PoolBytes - Heap->FreeBytes - (Heap->nUsed + Heap->nUnused + 2 * Heap->nSegments) * BLOCK_SIZE + Heap->DirectBytes - Heap->QuickBytes;
+	// Every block, and both fences of every segment, spends a header; mapped blocks lie outside the pool, and deferred blocks were released
+}
+
+/********************************************************************************
+*																				*
+*								MemGiveBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to return a used block to the free blocks
+// Input:	Heap, and used block to release
+// Return:	No return value
+
+void MemGiveBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	MemBlock->Size &= ~MEM_USED;// Remove usage encoding in bit 0
+
+	MemBlock = MemInsertIntoFreeBlocks (Heap, MemBlock);// Put block back into the free blocks
+
+	if (Heap->Settings & MEM_TRIM)	// If requested, return a wholly free segment to the system
+		MemTrimPool (Heap, MemBlock);
+
+	--Heap->nUsed;	// Document removal of used memory block
+}
+
+/********************************************************************************
+*																				*
+*								MemDeferBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to return a used block to the pool, holding small blocks back from coalescing in deferred mode
+// Input:	Heap, and used block to release
+// Return:	No return value
+
+void MemDeferBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	Dword Size = MemBlock->Size ^ MEM_USED;	// Size of block
+
+	if (!(Heap->Settings & MEM_DEFER) || Size >= SMALL_LIMIT)	// Coalesce other blocks at once
+	{
+		MemGiveBlock (Heap, MemBlock);
+
+		return;
+	}
+
+	MemBlock->pFree = Heap->Quick [Size / MEM_GRAIN];	// Push block onto its list; it stays marked used, so neighbours leave it be
+	Heap->Quick [Size / MEM_GRAIN] = MemBlock;
+
+	++Heap->nQuick;	// Document deferral of block
+	Heap->QuickBytes += Size;
+}
+
+/********************************************************************************
+*																				*
+*								MemCompactHeap									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to coalesce every deferred block into the free blocks; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+void MemCompactHeap (pmMEMORY Heap)
+{
+	int index;	// Loop variable
+
+	for (index = 0; index < SMALL_BINS && Heap->nQuick != 0; ++index)	// Loop through lists
+	{
+		while (Heap->Quick [index] != NULL)	// Pop and release each block
+		{
+			ptMEMBLOCK MemBlock = Heap->Quick [index];	// Refer to top of list
+
+			Heap->Quick [index] = MemBlock->pFree;
+
+			--Heap->nQuick;	// Document release of deferred block
+			Heap->QuickBytes -= MemBlock->Size ^ MEM_USED;
+
+			MemGiveBlock (Heap, MemBlock);
+		}
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemFlipDeferred									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to mark every deferred block as such, or to restore them as used; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+void MemFlipDeferred (pmMEMORY Heap)
+{
+	int index;	// Loop variable
+
+	for (index = 0; index < SMALL_BINS && Heap->nQuick != 0; ++index)	// Loop through lists
+	{
+		ptMEMBLOCK MemBlock;// Block being marked
+
+		for (MemBlock = Heap->Quick [index]; MemBlock != NULL; MemBlock = MemBlock->pFree)
+			MemBlock->Size ^= MEM_USED ^ MEM_DEFERRED;	// Trade usage for the mark, or back
+	}
+}
+
+/********************************************************************************
+*																				*
+*								MemGuardBlock									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to write a used block's trailer: canary bytes past the request, then its keyed size
+// Input:	Used block, and size of request
+// Return:	No return value
+
+void MemGuardBlock (ptMEMBLOCK MemBlock, Dword numBytes)
+{
+	Pbyte Data = (Pbyte) &MemBlock [BASE_EXTENT];	// Block's data
+
+	Dword Size = MemBlock->Size ^ MEM_USED;	// Size of block
+	Dword Key = numBytes ^ (Dword)((size_t) MemBlock ^ GUARD_KEY);	// Request size, keyed to block
+
+	memset (Data + numBytes, MEM_CANARY, Size - numBytes - sizeof(Dword));	// Fill up to the key
+
+	memcpy (Data + Size - sizeof(Dword), &Key, sizeof(Dword));	// Key may be unaligned
+}
+
+/********************************************************************************
+*																				*
+*								MemGuardCheck									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to validate a used block's links and trailer, aborting on damage
+// Input:	Used block
+// Return:	Size of request
+
+Dword MemGuardCheck (ptMEMBLOCK MemBlock)
+{
+	Pbyte Data = (Pbyte) &MemBlock [BASE_EXTENT];	// Block's data
+
+	Dword Size = MemBlock->Size & ~(Dword) MEM_USED;// Size of block
+	Dword numBytes, index;	// Size of request, and loop variable
+
+	if ((MemBlock->Size & (MEM_USED | MEM_FENCE)) != MEM_USED)	// Block must be in use
+		MemGuardFault (MemBlock, "release of free memory");
+
+	if (MemBlock->Next->Prev != MemBlock || MemBlock->Prev->Next != MemBlock)	// An overrun reaches the next header's links first
+		MemGuardFault (MemBlock, "corrupt block links");
+
+	for (index = 0; index < sizeof(MemBlock->Pattern); ++index)	// A released block wears a poisoned pattern
+		if (MemBlock->Pattern [index] != MEM_POISON) break;
+
+	if (index == sizeof(MemBlock->Pattern))
+		MemGuardFault (MemBlock, "double release");
+
+	memcpy (&numBytes, Data + Size - sizeof(Dword), sizeof(Dword));	// Recover request size
+
+	numBytes ^= (Dword)((size_t) MemBlock ^ GUARD_KEY);
+
+	if (numBytes + GUARD_BYTES > Size)	// A damaged key decodes to nonsense
+		MemGuardFault (MemBlock, "overrun into trailer");
+
+	for (index = numBytes; index < Size - sizeof(Dword); ++index)	// Canary bytes must be intact
+		if (Data [index] != MEM_CANARY) MemGuardFault (MemBlock, "overrun into trailer");
+
+	return numBytes;
+	// Return size of request
+}
+
+/********************************************************************************
+*																				*
+*								MemQuarantineBlock								*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to validate and poison a released block, holding it back in place of the oldest one
+// Input:	Heap, and used block to release
+// Return:	Oldest block, now due for release, if the quarantine was full; NULL otherwise
+
+ptMEMBLOCK MemQuarantineBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	ptMEMBLOCK Oldest;	// Block leaving quarantine
+
+	Dword index;// Loop variable
+
+	if (Heap->Settings & MEM_THREADSAFE) MemLock(&Heap->Lock);	// Neighbours and quarantine belong to the heap
+
+	MemGuardCheck (MemBlock);	// Catch overruns and double releases
+
+	memset (&MemBlock [BASE_EXTENT], MEM_POISON, MemBlock->Size ^ MEM_USED);	// Poison block; its pattern marks it released
+	memset (MemBlock->Pattern, MEM_POISON, sizeof(MemBlock->Pattern));
+
+	Oldest = Heap->Quarantine [Heap->QuarantineNext];	// Replace oldest block
+	Heap->Quarantine [Heap->QuarantineNext] = MemBlock;
+
+	Heap->QuarantineNext = (Heap->QuarantineNext + 1) % QUARANTINE_DEPTH;
+
+	if (Heap->Settings & MEM_THREADSAFE) MemUnlock(&Heap->Lock);
+
+	if (Oldest != NULL)	// Poison must be intact after its stay; sizes are whole grains, so compare words
+	{
+		size_t const * Data = (size_t const *) &Oldest [BASE_EXTENT];	// Oldest block's data
+		size_t const Poison = (size_t) -1 / 0xFF * MEM_POISON;	// Word of poison bytes
+
+		for (index = 0; index < (Oldest->Size ^ MEM_USED) / sizeof(size_t); ++index)
+			if (Data [index] != Poison) MemGuardFault (Oldest, "write after release");
+	}
+
+	return Oldest;
+	// Return block due for release
+}
+
+/********************************************************************************
+*																				*
+*								MemDrainQuarantine								*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release every quarantined block to the free blocks; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+void MemDrainQuarantine (pmMEMORY Heap)
+{
+	int index;	// Loop variable
+
+	for (index = 0; index < QUARANTINE_DEPTH; ++index)	// Loop through quarantine
+	{
+		if (Heap->Quarantine [index] != NULL) MemGiveBlock (Heap, Heap->Quarantine [index]);
+
+		Heap->Quarantine [index] = NULL;
+	}
+
+	Heap->QuarantineNext = 0;
+}
+
+/********************************************************************************
+*																				*
+*								MemGuardFault									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to report damage to a block and abort
+// Input:	Damaged block, and description of the damage
+// Return:	No return value
+
+void MemGuardFault (ptMEMBLOCK MemBlock, char const * Fault)
+{
+	fprintf (stderr, "Memory fault: %s at %p\n", Fault, (void *) &MemBlock [BASE_EXTENT]);
+
+	abort ();	// Leave the damage in place for a dump
+}
+
+/********************************************************************************
+*																				*
+*								MemSetKey										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to load a used block's pattern with its key: a marked allocation site, pattern bytes, or 0
+// Input:	Used block, and key
+// Return:	No return value
+
+void MemSetKey (ptMEMBLOCK MemBlock, unsigned long long Key)
+{
+	memcpy (MemBlock->Pattern, &Key, sizeof(MemBlock->Pattern));
+}
+
+/********************************************************************************
+*																				*
+*								MemIsHeld										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to tell whether a used block is held in quarantine
+// Input:	Heap, and used block
+// Return:	Whether the block is held
+
+BOOL MemIsHeld (pmMEMORY Heap, ptMEMBLOCK MemBlock)
+{
+	int index;	// Loop variable
+
+	if (!(Heap->Settings & MEM_GUARD))	// Only guarded heaps hold blocks
+		return FALSE;
+
+	for (index = 0; index < (int) sizeof(MemBlock->Pattern); ++index)	// Held blocks wear a poisoned pattern
+		if (MemBlock->Pattern [index] != MEM_POISON) return FALSE;
+
+	return TRUE;
+}
+
+/********************************************************************************
+*																				*
+*								MemThreadCache									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to get the calling thread's cache, creating it on first use
+// Input:	No input
+// Return:	Pointer to the cache, if available; NULL otherwise
+
+PRIVATE ptMEMCACHE MemThreadCache (void)
+{
+	if (MemCacheGeneration == MemGeneration)// Thread already has a live cache
+		return MemCache;
+
+	MemCache = (ptMEMCACHE) MemSysAlloc(sizeof(tMEMCACHE));	// Caches live outside the pool
+
+	if (MemCache == NULL)	// Ascertain that allocation succeeded
+		return NULL;
+
+	MemLock(&MemMgr.Lock);	// Register cache, so termination can reclaim its blocks
+
+	MemCache->Next = MemMgr.Caches;
+
+	if (MemMgr.Caches != NULL) MemMgr.Caches->Prev = MemCache;
+
+	MemMgr.Caches = MemCache;
+
+	MemUnlock(&MemMgr.Lock);
+
+	MemCacheGeneration = MemGeneration;
+
+	return MemCache;
+	// Return new cache
+}
+
+/********************************************************************************
+*																				*
+*								MemCacheAlloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to take a small block from the calling thread's cache, refilling it if empty
+// Input:	Size of request, rounded to allocation granularity
+// Return:	Used block, if successful; NULL otherwise
+
+ptMEMBLOCK MemCacheAlloc (Dword Size)
+{
+	ptMEMCACHE Cache = MemThreadCache ();	// Calling thread's cache
+	ptMEMBLOCK MemBlock;// Allocated block
+
+	Dword Class = Size / MEM_GRAIN;	// Cache slot matching request
+	Dword index;// Loop variable
+
+	if (Cache == NULL)	// Without a cache, fall back to the pool
+	{
+		MemLock(&MemMgr.Lock);
+
+		MemBlock = MemTakeBlock (&MemMgr, Size, 0);
+
+		MemUnlock(&MemMgr.Lock);
+
+		return MemBlock;
+	}
+
+	if (Cache->Slots [Class] == NULL)	// Refill an empty slot with half a magazine in one pass
+	{
+		MemLock(&MemMgr.Lock);
+
+		for (index = 0; index < (MemMgr.CacheDepth + 1) / 2; ++index)
+		{
+			MemBlock = MemTakeBlock (&MemMgr, Size, 0);
+
+			if (MemBlock == NULL)	// Pool is exhausted
+				break;
+
+			MEM_LINK(MemBlock) = Cache->Slots [Class];	// Push block onto slot
+			Cache->Slots [Class] = MemBlock;
+
+			++Cache->Counts [Class];
+
+			MemTally(&Cache->nBlocks, 1);
+			MemTally(&Cache->Bytes, MemBlock->Size ^ MEM_USED);
+		}
+
+		MemUnlock(&MemMgr.Lock);
+
+		if (Cache->Slots [Class] == NULL)	// If no blocks were found, return NULL
+			return NULL;
+	}
+
+	MemBlock = Cache->Slots [Class];// Pop block from slot
+	Cache->Slots [Class] = MEM_LINK(MemBlock);
+
+	--Cache->Counts [Class];
+
+	MemTally(&Cache->nBlocks, -1);
+	MemTally(&Cache->Bytes, 0 - (MemBlock->Size ^ MEM_USED));
+
+	return MemBlock;
+	// Return cached block
+}
+
+/********************************************************************************
+*																				*
+*								MemCacheFree									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to put an unkeyed block into the calling thread's cache, flushing it if full
+// Input:	Used block to release
+// Return:	No return value
+
+void MemCacheFree (ptMEMBLOCK MemBlock)
+{
+	ptMEMCACHE Cache;	// Calling thread's cache
+
+	unsigned long long Key;	// Block's key
+
+	Dword Size = MemBlock->Size ^ MEM_USED;	// Size of block
+	Dword Class = Size / MEM_GRAIN;	// Cache slot matching block
+	Dword index;// Loop variable
+
+	memcpy (&Key, MemBlock->Pattern, sizeof(MemBlock->Pattern));
+
+	if (Size == 0 || Size >= SMALL_LIMIT || Key != 0 || (Cache = MemThreadCache ()) == NULL)	// Return large, empty and keyed blocks straight to pool, so cached blocks come back unkeyed
+	{
+		MemLock(&MemMgr.Lock);
+
+		MemGiveBlock (&MemMgr, MemBlock);
+
+		MemUnlock(&MemMgr.Lock);
+
+		return;
+	}
+
+	MEM_LINK(MemBlock) = Cache->Slots [Class];	// Push block onto slot
+	Cache->Slots [Class] = MemBlock;
+
+	MemTally(&Cache->nBlocks, 1);
+	MemTally(&Cache->Bytes, Size);
+
+	if (++Cache->Counts [Class] <= MemMgr.CacheDepth)	// If slot has room, finish up
+		return;
+
+	MemLock(&MemMgr.Lock);	// Flush half a magazine to the pool in one pass
+
+	for (index = 0; index < (MemMgr.CacheDepth + 1) / 2; ++index)
+	{
+		MemBlock = Cache->Slots [Class];// Pop block from slot
+		Cache->Slots [Class] = MEM_LINK(MemBlock);
+
+		MemGiveBlock (&MemMgr, MemBlock);
+	}
+
+	MemUnlock(&MemMgr.Lock);
+
+	Cache->Counts [Class] -= index;
+
+	MemTally(&Cache->nBlocks, 0 - index);
+	MemTally(&Cache->Bytes, 0 - index * Size);
+}
+
 /********************************************************************************
 *																				*
-*								MemInit											*
+*								MemCacheFlush									*
 *																				*
 ********************************************************************************/	
 
-// Purpose:	Initializes a memory manager
-// Input:   No input
-// Return:  A code indicating the results of the initialization 
+// Purpose:	Used to return all of a cache's blocks to the free blocks; lock must be held
+// Input:	Cache to flush
+// Return:	No return value
 
-RETCODE MemInit (uMCONFIG * Config)
+void MemCacheFlush (ptMEMCACHE Cache)
 {
-	Dword PoolSize = ALIGNED(Config->PoolSize);	// Get requested size of memory frame
+	int index;	// Loop variable
 
-	MemMgr.Pool = (ptMEMBLOCK) malloc (PoolSize);
-	// Allocate memory for manager object and pool
+	for (index = 0; index < SMALL_BINS; ++index)// Loop through slots
+	{
+		while (Cache->Slots [index] != NULL)// Pop and release each block
+		{
+			ptMEMBLOCK MemBlock = Cache->Slots [index];	// Refer to top of slot
 
-	if (MemMgr.Pool == NULL)	// Ascertain that malloc succeeded
-		return RETCODE_FAILURE;	// Return failure
+			Cache->Slots [index] = MEM_LINK(MemBlock);
 
-	MemMgr.Pool->Size = PoolSize - sizeof(tMEMBLOCK);	// Set pool amount available
-	MemMgr.Pool->Prev = MemMgr.Pool->Next = MemMgr.Pool;// Link pool entries to self
+			MemGiveBlock (&MemMgr, MemBlock);
+		}
 
-	_asm {
-		mov esi, [MemMgr]._Pool;/* Initialize the memory pool */
-		call MemInsertIntoFreeBlocks;
+		Cache->Counts [index] = 0;
 	}
 
-	return RETCODE_SUCCESS;
-	// Return success
+	Cache->nBlocks = 0;	// Totals are read under the lock, so may be cleared directly
+	Cache->Bytes = 0;
 }
 
 /********************************************************************************
 *																				*
-*								MemTerm											*
+*								MemTraceRecord									*
 *																				*
 ********************************************************************************/	
 
-// Purpose:	Deinitializes a memory manager
-// Input:   Optional name of a log file
-// Return:  A code indicating the results of the termination
-
-RETCODE MemTerm (char const * LogFile)
-{		
-	if (LogFile != NULL)	// User requests diagnostics
-	{
-		ptMEMBLOCK MemBlock = MemMgr.Pool;	// Refer to first memory block
+// Purpose:	Used to append an operation to the trace file under the trace lock
+// Input:	Traced operation, request size, options, alignment, block operated on, and prior block or pattern
+// Return:	No return value
 
-		FILE * fpLog;	// File used to log debug info
+void MemTraceRecord (Dword Op, Dword Size, FLAGS Options, Dword Alignment, void const * Address, unsigned long long Prior)
+{
+	if (MemTraceBusy)	// Leave out allocations made by the write of another record
+		return;
 
-		char Pattern [9] = {0};	// Buffer used to retrieve memory patterns
+	MemLock(&MemTraceLock);
 
-		fpLog = fopen (LogFile, "wt");	// Create a log file
+	MemTraceWrite (Op, Size, Options, Alignment, Address, Prior);
 
-		if (fpLog != NULL)	// Log diagnostics if file creation was successful
-		{
-			// Output used entry/byte information
-			fprintf (fpLog, "%d unfreed entries\n", MemMgr.nUsed);
+	MemUnlock(&MemTraceLock);
+}
 
-			if (MemMgr.nUsed != 0) do {	// If memory is unfreed, list instances
-				if (MemBlock->Size & MEM_USED)	// Check if memory block is not freed
-				{
-					// Retrieve memory pattern
-					MemGetPattern (&MemBlock [BASE_EXTENT], Pattern);
+/********************************************************************************
+*																				*
+*								MemTraceWrite									*
+*																				*
+********************************************************************************/	
 
-					if (Pattern [0] == '\0')	// Check for unlabeled blocks
-						fprintf (fpLog, "No pattern\n");	// Print message
+// Purpose:	Used to append an operation to the trace file, if a trace is still running; lock must be held
+// Input:	Traced operation, request size, options, alignment, block operated on, and prior block or pattern
+// Return:	No return value
 
-					else fprintf (fpLog, "Entry: %s\n", Pattern);	// Print pattern
+void MemTraceWrite (Dword Op, Dword Size, FLAGS Options, Dword Alignment, void const * Address, unsigned long long Prior)
+{
+	uMTRACE Record;	// Record of operation
 
-					fprintf (fpLog, "Bytes used: %u\n", MemBlock->Size ^ MEM_USED);	// Print memory consumption
-				}
+	if (MemTraceFile == NULL)	// Trace ended after the caller checked
+		return;
 
-				MemBlock = MemBlock->Next;	// Go to next block in memory chain
-			} while (MemBlock != MemMgr.Pool);	// Loop through all blocks
+	ZeroMemory(&Record,sizeof(uMTRACE));// Clear padding
 
-			fclose (fpLog);	// Close the log file
-		}
-	}
+	Record.Address = (size_t) Address;	// Load record
+	Record.Prior = Prior;
+	Record.Size = Size;
+	Record.Time = (Dword)(MemTicks () - MemTraceBase);
+	Record.Thread = MemThreadId();
+	Record.Op = (Byte) Op;
+	Record.Options = (Byte) Options;
+	Record.Shift = (Word)(Alignment > 1 ? MemLowBit(Alignment) : 0);
 
-	free (MemMgr.Pool);	// Deallocate memory manager pool
+	MemTraceBusy = TRUE;
 
-	ZeroMemory(&MemMgr,sizeof(mMEMORY));// Clear manager
+	fwrite (&Record, sizeof(uMTRACE), 1, MemTraceFile);	// Append record; the lock keeps threads from interleaving
 
-	return RETCODE_SUCCESS;
-	// Return success
+	MemTraceBusy = FALSE;
 }
 
 /********************************************************************************
 *																				*
-*								MemAlloc										*
+*								MemBinIndex										*
 *																				*
 ********************************************************************************/	
 
-// Purpose:	Used to allocate memory of a given size
-// Input:   Block size, and options
-// Return:	Pointer to the memory, if successful; NULL otherwise
+// Purpose:	Used to find the bin that holds blocks of a given size
+// Input:	Block size
+// Return:	Bin index
 
-QUICK void * MemAlloc (Dword numBytes, FLAGS Options)
+Dword MemBinIndex (Dword Size)
 {
-	_asm {
-		mov eax, [esp+4];/* Load request size, cache base, and count of blocks to scan */
-		mov esi, [MemMgr]._Cache;
-		mov ecx, [MemMgr]._nUnused;
-		add eax, 3;		/* Align request to next dword boundary; bits 0, 1 free */
-		and eax, not 3;
-$fMem:	cmp [esi]._Size, eax;	/* Scan through cache, stopping at first fit */
-		jae $mGood;
-		mov esi, [esi]._nFree;
-		dec ecx;
-		jnz $fMem;
-		xor eax, eax;	/* If no blocks were found, return NULL */
-		ret;
-$mGood:	call MemRemoveFromFreeBlocks;	/* Extract the memory block from the pool */
-		mov ecx, [esi]._Size;	/* Set the new block's size, and compute the padding left over */
-		mov [esi]._Size, eax;
-		sub ecx, eax;
-		or [esi]._Size, MEM_USED;	/* Encode usage in bit 0 */
-		cmp ecx, BLOCK_SIZE;/* If padding is inadequate to form a new block plus data, skip ahead */
-		jle $mPad;
-		mov edi, esi;	/* Cache old block */
-		sub ecx, BLOCK_SIZE;/* Determine the size of new block */
-		mov ebx, [edi]._Next;	/* Load offsets of new block and block after it */
-		lea esi, [edi+eax+BLOCK_SIZE];
-		mov [esi]._Size, ecx;	/* Set the new block's size */
-		mov [esi]._Prev, edi;	/* Update the blocks' connections */
-		mov [esi]._Next, ebx;
-		mov [ebx]._Prev, esi;
-		mov [edi]._Next, esi;
-		call MemInsertIntoFreeBlocks;	/* Put the new block back into the free blocks */
-		mov esi, edi;	/* Restore old block */
-		xor ecx, ecx;	/* Zero out padding */
-$mPad:	add [esi]._Size, ecx;	/* Accumulate leftover padding into allocated block */
-		mov [esi]._Pattern, 0;	/* Effectively zero out block's pattern */
-		test [esp+8], MEM_ZERO;	/* If requested, zero out the block's memory */
-		jz $mNo0;
-		cld;
-		mov ecx, [esi]._Size;
-		xor	eax, eax;
-		shr	ecx, 2;
-		lea edi, [esi]._DATA;
-		rep stosd;
-$mNo0:	lea eax, [esi]._DATA;	/* Load pointer to allocated memory as return value */
-		inc dword ptr [MemMgr].nUsed;	/* Document addition of used memory block */
-		ret;/* Return to caller */
-	}
+	Dword Bin;	// Power-of-two bin index
+
+	if (Size < SMALL_LIMIT)	// Exact bins are indexed by grain count
+		return Size / MEM_GRAIN;
+
+	Bin = SMALL_BINS + MemHighBit(Size) - LARGE_SHIFT;	// Power-of-two bins are indexed by most significant bit
+
+	return Bin < NUM_BINS ? Bin : NUM_BINS - 1;
+	// Return bin, folding oversized blocks into the last bin
 }
 
 /********************************************************************************
 *																				*
-*								MemFree											*
+*								MemRemoveFromFreeBlocks							*
 *																				*
 ********************************************************************************/	
 
-// Purpose: Used to release memory
-// Input:   Context to release
-// Return:  No return value
+// Purpose:	Used to extract a block from the free blocks
+// Input:	Heap, and memory block to extract
+// Return:	No return value
 
-QUICK void MemFree (void * memory)
+void MemRemoveFromFreeBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock)
 {
-	_asm {
-		mov esi, [esp+4];	/* Obtain the block preceding the memory variable */
-		sub esi, BLOCK_SIZE;
-		and [esi]._Size, not MEM_USED;	/* Remove usage encoding in bit 0 */
-		call MemInsertIntoFreeBlocks;	/* Put block back into the free blocks */
-		dec dword ptr [MemMgr].nUsed;	/* Document removal of used memory block */
-		ret;/* Return to caller */
+	Dword Bin = MemBinIndex (MemBlock->Size);	// Find the block's bin
+
+	if (MemBlock->nFree == MemBlock)// If block is alone in its bin, empty the bin and clear its bit
+	{
+		Heap->Bins [Bin] = NULL;
+		Heap->BinMap &= ~(1ULL << Bin);
+	}
+
+	else
+	{
+		if (Heap->Bins [Bin] == MemBlock)	// Reassign bin base to next free block in sequence
+			Heap->Bins [Bin] = MemBlock->nFree;
+
+		MemBlock->pFree->nFree = MemBlock->nFree;	// Update the blocks' free block connections
+		MemBlock->nFree->pFree = MemBlock->pFree;
 	}
+
+	--Heap->nUnused;	// Document the removal of a free block
+	Heap->FreeBytes -= MemBlock->Size;
 }
 
 /********************************************************************************
 *																				*
-*								MemGetPattern									*
+*								MemInsertIntoFreeBlocks							*
 *																				*
-********************************************************************************/
+********************************************************************************/	
 
-// Purpose:	Used to retrieve a pattern used to identify memory
-// Input:   Memory variable associated with pattern, and a buffer to load
-// Return:  A code indicating the results of getting the pattern
+// Purpose:	Used to place a block within the free blocks
+// Input:	Heap, and memory block to insert
+// Return:	Block resulting from adjoinment
 
-RETCODE MemGetPattern (void * memory, char Pattern [])
+ptMEMBLOCK MemInsertIntoFreeBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock)
 {
-	ptMEMBLOCK MemBlock;// Owner memory block
+	ptMEMBLOCK Base, Next, Last;// Bin base, block to insert before, and block to insert after
 
-	int index;	// Loop variable
+	Dword Bin;	// Bin of the resulting block
+	Dword Steps;// Blocks examined from each end of bin
 
-	MemBlock = (ptMEMBLOCK)((Pbyte) memory - sizeof(tMEMBLOCK));
-	// Refer to memory's owning block
+	MemBlock = MemAdjoinBlocks (Heap, MemBlock);	// Attempt to join new block into memory
 
-	for (index = 0; index < 8; ++index)	// Loop through pattern
+	Bin = MemBinIndex (MemBlock->Size);	// Find the bin of the resulting block
+
+	Base = Next = Heap->Bins [Bin];
+
+	if (Base == NULL)	// Refer block to itself, and mark the bin non-empty
 	{
-		Pattern [index] = MemBlock->Pattern [index];// Get byte
+		MemBlock->pFree = MemBlock->nFree = MemBlock;
 
-		if (MemBlock->Pattern [index] == '\0')	// Check for null bytes
-			break;	// Pattern is complete
+		Heap->BinMap |= 1ULL << Bin;
 	}
 
-	return RETCODE_SUCCESS;
-	// Return success
+	else// Update the blocks' free connections
+	{
+		if (Heap->Placement == MEM_ADDRESS_FIT)	// Keep the bin in address order, walking in from both ends
+		{
+			Last = Base->pFree;
+
+			for (Steps = 0; Steps < SCAN_LIMIT; ++Steps)// Past the limit, block settles among the lowest blocks
+			{
+				if (Next > MemBlock)// Block lies below the next one
+					break;
+
+				if (Last < MemBlock)// Block lies above the last one
+				{
+					Next = Last->nFree;
+
+					break;
+				}
+
+				Next = Next->nFree;
+				Last = Last->pFree;
+			}
+		}
+
+		MemBlock->pFree = Next->pFree;	// Put block before the next one
+		MemBlock->nFree = Next;
+		Next->pFree->nFree = MemBlock;
+		Next->pFree = MemBlock;
+	}
+
+	if (Base == NULL || Heap->Placement == MEM_FIRST_FIT || Heap->Placement == MEM_BEST_FIT)
+		Heap->Bins [Bin] = MemBlock;// Make block the bin base, so recent blocks are reused first
+
+	else if (Heap->Placement == MEM_ADDRESS_FIT && MemBlock < Base)
+		Heap->Bins [Bin] = MemBlock;// Make lowest block the bin base
+
+	// Next fit leaves the bin's rover in place, queuing the block behind it
+
+	++Heap->nUnused;	// Document the addition of a free block
+	Heap->FreeBytes += MemBlock->Size;
+
+	return MemBlock;
+	// Return resulting block
 }
 
 /********************************************************************************
 *																				*
-*								MemSetPattern									*
+*								MemAdjoinBlocks									*
 *																				*
-********************************************************************************/
+********************************************************************************/	
 
-// Purpose:	Used to associate a pattern to a memory variable
-// Input:   Memory variable to associate with pattern, and pattern to assign
-// Return:  A code indicating the results of setting the pattern
+// Purpose:	Used to adjoin memory
+// Input:	Heap, and memory block to adjoin
+// Return:	Block resulting from adjoinment
 
-RETCODE MemSetPattern (void * memory, char Pattern [])
+ptMEMBLOCK MemAdjoinBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock)
 {
-	ptMEMBLOCK MemBlock;// Owner memory block
+	ptMEMBLOCK Next = MemBlock->Next, Prev = MemBlock->Prev;// Physical neighbours
 
-	int index;	// Loop variable
+	if (Heap->Settings & MEM_GUARD)	// Neighbours must link back to the block, and free ones into their rings
+	{
+		if (Next->Prev != MemBlock || Prev->Next != MemBlock)
+			MemGuardFault (MemBlock, "corrupt block links");
 
-	MemBlock = (ptMEMBLOCK)((Pbyte) memory - sizeof(tMEMBLOCK));
-	// Refer to memory's owning block
+		if (Next != MemBlock && !(Next->Size & MEM_USED) && (Next->nFree->pFree != Next || Next->pFree->nFree != Next))
+			MemGuardFault (Next, "corrupt free ring");
 
-	for (index = 0; index < 8; ++index)	// Loop through pattern
+		if (Prev != MemBlock && !(Prev->Size & MEM_USED) && (Prev->nFree->pFree != Prev || Prev->pFree->nFree != Prev))
+			MemGuardFault (Prev, "corrupt free ring");
+	}
+
+	if (Next > MemBlock && !(Next->Size & MEM_USED))// Check whether next block is upper in memory and free
 	{
-		MemBlock->Pattern [index] = Pattern [index];// Set byte
+		MemRemoveFromFreeBlocks (Heap, Next);	// Take next block out of its bin
 
-		if (MemBlock->Pattern [index] == '\0')	// Check for null bytes
-			break;	// Pattern is complete
+		MemBlock->Size += Next->Size + BLOCK_SIZE;	// Enlarge block by next block
+
+		MemBlock->Next = Next->Next;// Update blocks' connections
+		MemBlock->Next->Prev = MemBlock;
 	}
 
-	return RETCODE_SUCCESS;
-	// Return success
+	if (Prev < MemBlock && !(Prev->Size & MEM_USED))// Check whether last block is lower in memory and free
+	{
+		MemRemoveFromFreeBlocks (Heap, Prev);	// Take last block out of its bin
+
+		Prev->Size += MemBlock->Size + BLOCK_SIZE;	// Enlarge last block by this block
+
+		Prev->Next = MemBlock->Next;// Update blocks' connections
+		Prev->Next->Prev = Prev;
+
+		MemBlock = Prev;// Last block absorbs this one
+	}
+
+	return MemBlock;
+	// Return resulting block
+}
+
+#ifdef MEM_SHIM
+
+/********************************************************************************
+*																				*
+*								MemForkPrepare									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to hold the global manager still across fork, so the child inherits its lock unheld
+// Input:	No input
+// Return:	No return value
+
+void MemForkPrepare (void)
+{
+	MemLock(&MemMgr.Lock);
+}
+
+/********************************************************************************
+*																				*
+*								MemForkRelease									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to release the global manager after fork, in both parent and child
+// Input:	No input
+// Return:	No return value
+
+void MemForkRelease (void)
+{
+	MemUnlock(&MemMgr.Lock);
+}
+
+#endif // MEM_SHIM
+
+#else // MEM_PORTABLE
+
+/********************************************************************************
+*																				*
+*								MemBinIndex										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to find the bin that holds blocks of a given size
+// Input:	EAX : Block size
+// Return:	ECX : Bin index
+
+QUICK void MemBinIndex (void)
+{
+	_asm {
+		mov ecx, eax;	/* Load size, and check whether it falls in an exact bin */
+		cmp ecx, SMALL_LIMIT;
+		jae $bLarge;
+		shr ecx, 2;	/* Exact bins are indexed by dword count */
+		ret;/* Return to caller */
+$bLarge:bsr ecx, ecx;	/* Power-of-two bins are indexed by most significant bit */
+		add ecx, SMALL_BINS - LARGE_SHIFT;
+		ret;/* Return to caller */
+	}
 }
 
 /********************************************************************************
@@ -259,14 +3620,23 @@ RETCODE MemSetPattern (void * memory, char Pattern [])
 QUICK void MemRemoveFromFreeBlocks (void)
 {
 	_asm {
+		push eax;	/* Save EAX */
+		mov eax, [esi]._Size;	/* Find the block's bin */
+		call MemBinIndex;
 		mov ebx, [esi]._pFree;	/* Load last and next free blocks */
 		mov edx, [esi]._nFree;
-		cmp [MemMgr]._Cache, esi;	/* If block to remove is not the cache base, skip ahead */
+		cmp edx, esi;	/* If block is not alone in its bin, skip ahead */
+		jne $mMore;
+		mov dword ptr [MemMgr+_Bins+ecx*4], 0;	/* Empty the bin, and clear its bit */
+		btr dword ptr [MemMgr+_BinMap], ecx;
+		jmp $mDone;
+$mMore:	cmp [MemMgr+_Bins+ecx*4], esi;	/* If block to remove is not the bin base, skip ahead */
 		jne $mNo;
-		mov [MemMgr]._Cache, edx;	/* Reassign cache to next free block in sequence */
+		mov [MemMgr+_Bins+ecx*4], edx;	/* Reassign bin base to next free block in sequence */
 $mNo:	mov [ebx]._nFree, edx;	/* Update the blocks' free block connections */
 		mov [edx]._pFree, ebx;
-		dec dword ptr [MemMgr]._nUnused;/* Document the removal of a free block */
+$mDone:	dec dword ptr [MemMgr]._nUnused;/* Document the removal of a free block */
+		pop eax;/* Restore EAX */
 		ret;/* Return to caller */
 	}
 }
@@ -284,23 +3654,24 @@ $mNo:	mov [ebx]._nFree, edx;	/* Update the blocks' free block connections */
 QUICK void MemInsertIntoFreeBlocks (void)
 {
 	_asm {
-		cmp dword ptr [MemMgr]._nUnused, 0;	/* If the cache is not empty, skip ahead */
-		jne $mNZ;
-		mov [MemMgr]._Cache, esi;	/* Load cache base */
-		mov [esi]._pFree, esi;	/* Refer cache to itself, and finish up */
+		call MemAdjoinBlocks;	/* Attempt to join new block into memory */
+		mov eax, [esi]._Size;	/* Find the bin of the resulting block */
+		call MemBinIndex;
+		mov ebx, [MemMgr+_Bins+ecx*4];	/* Load bin base; if the bin is not empty, skip ahead */
+		test ebx, ebx;
+		jnz $mNZ;
+		mov [esi]._pFree, esi;	/* Refer block to itself, and mark the bin non-empty */
 		mov [esi]._nFree, esi;
+		bts dword ptr [MemMgr+_BinMap], ecx;
 		jmp $mEnd;
-$mNZ:	call MemAdjoinBlocks;	/* Attempt to join new block into memory */
-		mov ebx, [MemMgr]._Cache;	/* Load cache base and next free block */
-		cmp eax, 2;
-		mov edx, [ebx]._nFree;
-		jne $mDone;	/* If block attached itself to memory, insertion is complete */
-		mov [esi]._pFree, ebx;	/* Update the blocks' free connections */
-		mov [esi]._nFree, edx;
-		mov [ebx]._nFree, edx;
-		mov [edx]._pFree, ebx;
-$mEnd:	inc dword ptr [MemMgr]._nUnused;/* Document the addition of a free block */
-$mDone:	ret;/* Return to caller */
+$mNZ:	mov edx, [ebx]._pFree;	/* Load last free block in bin */
+		mov [esi]._pFree, edx;	/* Update the blocks' free connections */
+		mov [esi]._nFree, ebx;
+		mov [edx]._nFree, esi;
+		mov [ebx]._pFree, esi;
+$mEnd:	mov [MemMgr+_Bins+ecx*4], esi;	/* Make block the bin base, so recent blocks are reused first */
+		inc dword ptr [MemMgr]._nUnused;/* Document the addition of a free block */
+		ret;/* Return to caller */
 	}
 }
 
@@ -312,61 +3683,46 @@ $mDone:	ret;/* Return to caller */
 
 // Purpose:	Used to adjoin memory
 // Input:	ESI : Memory block to adjoin
-// Return:	Amount of non-adjoinments
+// Return:	ESI : Block resulting from adjoinment
 
-QUICK long MemAdjoinBlocks (void)
+QUICK void MemAdjoinBlocks (void)
 {
 	_asm {
-		mov eax, 2;	/* Set initial non-adjoinment counter */
 		mov ebx, [esi]._Next;	/* Load next block, and check whether it's upper in memory and free */
 		cmp ebx, esi;
-		jle $uBad;
+		jbe $uBad;
 		test [ebx]._Size, MEM_USED;
 		jnz $uBad;
-		mov ecx, [ebx]._Size;	/* Enlarge next block; next block may be cache base, so reassign base */
+		push esi;	/* Take next block out of its bin */
+		mov esi, ebx;
+		call MemRemoveFromFreeBlocks;
+		pop esi;
+		mov ebx, [esi]._Next;	/* Enlarge block by next block */
+		mov ecx, [ebx]._Size;
 		add ecx, BLOCK_SIZE;
-		mov [MemMgr]._Cache, esi;
 		add [esi]._Size, ecx;
 		mov edx, [ebx]._Next;	/* Update blocks' connections */
 		mov [esi]._Next, edx;
 		mov [edx]._Prev, esi;
-		mov edx, [ebx]._Next;	/* Reassign next block, and decrement non-adjoinment counter */
-		dec eax;/* Decrement non-adjoinment counter */
-		cmp dword ptr [MemMgr]._nUnused, 1;	/* Skip ahead if next block is not only block in cache */
-		jne $More;
-		mov [esi]._pFree, esi;	/* If next block is alone, bind this block to itself, and finish up */
-		mov [esi]._nFree, esi;
-		ret;
-$More:	mov ecx, [ebx]._pFree;	/* Load last and next free blocks */
-		mov edx, [ebx]._nFree;
-		mov [esi]._pFree, ecx;	/* Update the blocks' free block connections */
-		mov [esi]._nFree, edx;
-		mov [ecx]._nFree, esi;
-		mov [edx]._pFree, esi;
 $uBad:	mov ebx, [esi]._Prev;	/* Load last block, and check whether it's lower in memory and free */
 		cmp ebx, esi;
-		jge $lBad;
+		jae $lBad;
 		test [ebx]._Size, MEM_USED;
 		jnz $lBad;
-		mov ecx, [esi]._Size;	/* Enlarge last block; current block may be cache base, so reassign base */
+		push esi;	/* Take last block out of its bin */
+		mov esi, ebx;
+		call MemRemoveFromFreeBlocks;
+		pop esi;
+		mov ebx, [esi]._Prev;	/* Enlarge last block by this block */
+		mov ecx, [esi]._Size;
 		add ecx, BLOCK_SIZE;
-		mov [MemMgr]._Cache, ebx;
 		add [ebx]._Size, ecx;
 		mov edx, [esi]._Next;	/* Update blocks' connections */
 		mov [ebx]._Next, edx;
 		mov [edx]._Prev, ebx;
-		dec eax;/* Decrement non-adjoinment counter */
-		jnz $lFin;	/* Skip ahead if memory was not adjoined before */
-		dec dword ptr [MemMgr]._nUnused;/* Dual adjoinment reduces the block count; skip ahead if more than one block remains */
-		cmp dword ptr [MemMgr]._nUnused, 1;
-		jg $lFin;
-		mov [ebx]._pFree, ebx;	/* If block is alone, bind last block to itself, and finish up */
-		mov [ebx]._nFree, ebx;
-		ret;
-$lFin:	mov ecx, [esi]._pFree;	/* Load last and next free blocks */
-		mov edx, [esi]._nFree;
-		mov [ecx]._nFree, edx;	/* Update the blocks' free block connections */
-		mov [edx]._pFree, ecx;
+		mov esi, ebx;	/* Last block absorbs this one */
 $lBad:	ret;/* Return to caller */
 	}
-}
\ No newline at end of file
+}
+
+#endif // MEM_PORTABLE
\ No newline at end of file
@@ -87,6 +87,10 @@ LIB32=link.exe -lib
 
 SOURCE=.\Memory.c
 # End Source File
+# Begin Source File
+
+SOURCE=.\Slab.c
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -7,7 +7,7 @@
 *																	*
 ********************************************************************/
 
-#include "..\common.h"
+#include "../common.h"
 
 /********************************************************************
 *																	*
@@ -17,6 +17,48 @@
 
 #define MEM_ZERO 0x1	// Used to zero out allocated memory
 
+/* Configuration settings */
+#define MEM_THREADSAFE 0x1	// Manager may be shared among threads; requires the portable backend
+#define MEM_TRIM	   0x2	// Wholly free growth segments are returned to the system
+#define MEM_GUARD	   0x4	// Overruns and writes after release abort the program; requires the portable backend
+#define MEM_CALLSITES  0x8	// Blocks record the return address of their allocating call; requires the portable backend
+#define MEM_DEFER	   0x10	// Released small blocks wait on per-size lists, coalescing only on a miss or MemCompact; requires the portable backend
+
+/* Placement policies */
+#define MEM_FIRST_FIT	0	// Most recently freed block of the first fitting bin; the default
+#define MEM_NEXT_FIT	1	// Bins rove past the last block taken; requires the portable backend
+#define MEM_BEST_FIT	2	// Smallest fitting block of the first fitting bin; requires the portable backend
+#define MEM_ADDRESS_FIT	3	// Lowest fitting block of the first fitting bin; requires the portable backend
+
+/* Traced operations */
+#define MEM_TRACE_ALLOC		1	// MemAlloc or MemAllocAligned
+#define MEM_TRACE_FREE		2	// MemFree
+#define MEM_TRACE_REALLOC	3	// MemRealloc
+#define MEM_TRACE_PATTERN	4	// MemSetPattern
+
+/* Map export */
+#define MEM_MAP_CSV 0x1	// Map is written as comma-separated text rather than binary records
+
+/* Block states in maps */
+#define MEM_BLOCK_USED	0	// Block in use
+#define MEM_BLOCK_FREE	1	// Block among the free blocks
+#define MEM_BLOCK_FENCE	2	// Header bounding a growth segment
+#define MEM_BLOCK_HELD	3	// Released block held in quarantine by MEM_GUARD
+#define MEM_BLOCK_DIRECT 4	// Used block mapped on pages of its own, outside the chain
+#define MEM_BLOCK_DEFER	5	// Released block awaiting coalescing by MEM_DEFER
+
+/* Statistics */
+#define MEM_HISTOGRAM 0x40	// Count of size classes in the allocation histogram
+
+/********************************************************************
+*																	*
+*							Handles									*
+*																	*
+********************************************************************/
+
+typedef struct _mMEMORY * hHEAP;	// Handle to an independent heap
+typedef struct _tSLAB * hSLAB;		// Handle to a cache of fixed-size objects
+
 /********************************************************************
 *																	*
 *							User Types								*
@@ -25,9 +67,60 @@
 
 // User-configuration for memory
 typedef struct {
-	Dword PoolSize;	// Bytes to allocate for memory pool
+	Dword PoolSize;		// Bytes to allocate for memory pool
+	FLAGS Settings;		// Manager settings
+	Dword CacheDepth;	// Blocks each thread may cache per size class; 0 selects a default
+	Dword PoolLimit;	// Ceiling the pool may grow to; growth is disabled at or below PoolSize
+	Dword GrowthRate;	// Growth, as a percentage of the current pool; 0 selects a default
+	Dword Placement;	// Placement policy
+	Dword MapThreshold;	// Requests of at least this many bytes get pages of their own; 0 disables; requires the portable backend
 } uMCONFIG, * puMCONFIG;
 
+// Snapshot of a heap's statistics
+typedef struct {
+	Dword BytesUsed;	// Bytes in used blocks, headers excluded
+	Dword PeakBytes;	// Most bytes ever in used blocks; 0 where untracked
+	Dword FreeBytes;	// Bytes in free blocks, headers excluded, deferred blocks included
+	Dword LargestFree;	// Size of the largest free block
+	Dword PoolBytes;	// Bytes in the pool, growth segments included
+	Dword DeferredBytes;// Bytes in blocks awaiting coalescing by MEM_DEFER, headers excluded
+	Dword CachedBytes;	// Bytes in blocks held by thread caches, headers excluded
+	Dword nUsed;		// Count of used blocks
+	Dword nFree;		// Count of free blocks, deferred blocks included
+	Dword nDeferred;	// Count of blocks awaiting coalescing by MEM_DEFER
+	Dword nCached;		// Count of blocks held by thread caches
+	double Fragmentation;	// Share of free bytes lying outside the largest free block
+	double ScanLength;	// Average count of free blocks examined per search; 0 where untracked
+	Dword Histogram [MEM_HISTOGRAM];// Requests per size class: one per grain below 32 grains, then one per power of two
+} uMSTATS, * puMSTATS;
+
+// Record of one traced operation
+typedef struct {
+	unsigned long long Address;	// Block allocated, released, resized or labeled; 0 if an allocation failed
+	unsigned long long Prior;	// Block replaced by a resize, or pattern bytes of a labeling
+	Dword Size;		// Request size
+	Dword Time;		// Microseconds since tracing began
+	Dword Thread;	// Identifier of the calling thread
+	Byte Op;		// Traced operation
+	Byte Options;	// Allocation options
+	Word Shift;		// Base-two logarithm of an aligned allocation's alignment; 0 otherwise
+} uMTRACE, * puMTRACE;
+
+// Record of one block in a heap map
+typedef struct {
+	unsigned long long Address;	// Address of block's header
+	Dword Size;		// Size of block's data; 0 for fences
+	Dword State;	// Block state
+} uMMAPENTRY, * puMMAPENTRY;
+
+// Footprint of one allocation site
+typedef struct {
+	unsigned long long Site;	// Return address of the allocating call; 0 for tagged and untagged blocks
+	char Tag [9];	// Pattern shared by tagged blocks, terminated; empty otherwise
+	Dword Bytes;	// Bytes in the site's used blocks
+	Dword Count;	// Count of the site's used blocks
+} uMSITE, * puMSITE;
+
 /********************************************************************
 *																	*
 *							Interface								*
@@ -46,6 +139,12 @@ PUBLIC RETCODE MemTerm (char const * LogFile);
 // Input:   Optional name of a log file
 // Return:  A code indicating the results of the termination
 
+PUBLIC void MemThreadTerm (void);
+
+// Purpose:	Returns the calling thread's cached blocks to a thread-safe manager
+// Input:	No input
+// Return:	No return value
+
 PUBLIC void * MemAlloc (Dword numBytes, FLAGS Options);
 
 // Purpose:	Used to allocate memory of a given size
@@ -58,6 +157,132 @@ PUBLIC void MemFree (void * memory);
 // Input:   Context to release
 // Return:  No return value
 
+PUBLIC void * MemRealloc (void * memory, Dword numBytes);
+
+// Purpose:	Used to resize memory, in place where the pool allows
+// Input:	Context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+PUBLIC void * MemAllocAligned (Dword numBytes, Dword Alignment, FLAGS Options);
+
+// Purpose:	Used to allocate memory of a given size at a given alignment; MemRealloc may not keep it
+// Input:	Block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+PUBLIC Dword MemAllocBatch (Dword Count, Dword numBytes, void * Blocks [], FLAGS Options);
+
+// Purpose:	Used to allocate several blocks of one size at once, carved from a single free block where the pool allows
+// Input:	Count of blocks, block size, array to load, and options
+// Return:	Count of blocks allocated, which falls short of the count only if memory runs out
+
+PUBLIC void MemFreeBatch (void * Blocks [], Dword Count);
+
+// Purpose:	Used to release several blocks at once, merging neighbours among them before they rejoin the pool
+// Input:	Contexts to release, which are left sorted by address, and their count; NULL entries are skipped
+// Return:	No return value
+
+PUBLIC hHEAP MemHeapCreate (puMCONFIG Config);
+
+// Purpose:	Creates an independent heap; requires the portable backend
+// Input:	Pointer to a configuration structure
+// Return:	A handle to the new heap, if successful; NULL otherwise
+
+PUBLIC RETCODE MemHeapDestroy (hHEAP Heap);
+
+// Purpose:	Destroys a heap, along with everything allocated from it, without visiting its blocks
+// Input:	A heap handle
+// Return:	A code indicating the results of the destruction
+
+PUBLIC void * MemHeapAlloc (hHEAP Heap, Dword numBytes, FLAGS Options);
+
+// Purpose:	Used to allocate memory of a given size from a heap
+// Input:	A heap handle, block size, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+PUBLIC void MemHeapFree (hHEAP Heap, void * memory);
+
+// Purpose:	Used to release memory to a heap
+// Input:	A heap handle, and context to release
+// Return:	No return value
+
+PUBLIC void * MemHeapRealloc (hHEAP Heap, void * memory, Dword numBytes);
+
+// Purpose:	Used to resize memory from a heap, in place where the heap allows
+// Input:	A heap handle, context to resize, or NULL to allocate, and new block size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+PUBLIC void * MemHeapAllocAligned (hHEAP Heap, Dword numBytes, Dword Alignment, FLAGS Options);
+
+// Purpose:	Used to allocate memory of a given size at a given alignment from a heap
+// Input:	A heap handle, block size, power-of-two alignment, and options
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+PUBLIC RETCODE MemCompact (hHEAP Heap);
+
+// Purpose:	Used to coalesce a heap's deferred blocks into its free blocks
+// Input:	A heap handle, or NULL for the global manager
+// Return:	A code indicating the results of the compaction
+
+PUBLIC hSLAB MemSlabCreate (Dword SizeOfObject, Dword nPerSlab);
+
+// Purpose:	Creates a slab cache handing out objects of one size, with no per-object header
+// Input:	Per-object size, and objects per slab; 0 fits as many as a page holds
+// Return:	A handle to the new slab cache, if successful; NULL otherwise
+
+PUBLIC RETCODE MemSlabDestroy (hSLAB Slab);
+
+// Purpose:	Destroys a slab cache, along with all of its objects
+// Input:	A slab cache handle
+// Return:	A code indicating the results of the destruction
+
+PUBLIC void * MemSlabAlloc (hSLAB Slab);
+
+// Purpose:	Used to take an object from a slab cache
+// Input:	A slab cache handle
+// Return:	Pointer to the object, if successful; NULL otherwise
+
+PUBLIC void MemSlabFree (hSLAB Slab, void * Object);
+
+// Purpose:	Used to release an object to a slab cache
+// Input:	A slab cache handle, and object to release
+// Return:	No return value
+
+PUBLIC RETCODE MemGetStats (hHEAP Heap, puMSTATS Stats);
+
+// Purpose:	Used to take a snapshot of a heap's statistics
+// Input:	A heap handle, or NULL for the global manager, and structure to load
+// Return:	A code indicating the results of taking the snapshot
+
+PUBLIC RETCODE MemVerify (hHEAP Heap);
+
+// Purpose:	Used to validate a heap's links, free rings and block counts
+// Input:	A heap handle, or NULL for the global manager
+// Return:	A code indicating whether the heap is intact
+
+PUBLIC RETCODE MemExportMap (hHEAP Heap, char const * MapFile, FLAGS Options);
+
+// Purpose:	Used to write the address, size and state of every block in a heap, in address-chain order, then its mapped blocks
+// Input:	A heap handle, or NULL for the global manager, name of the map file, and options
+// Return:	A code indicating the results of writing the map
+
+PUBLIC Dword MemGetSites (hHEAP Heap, puMSITE Sites, Dword nSites);
+
+// Purpose:	Used to total a heap's used blocks by allocation site or pattern, largest footprint first
+// Input:	A heap handle, or NULL for the global manager, array to load, and its capacity
+// Return:	Count of distinct sites, which may exceed the capacity
+
+PUBLIC RETCODE MemTraceStart (char const * TraceFile);
+
+// Purpose:	Begins recording the global manager's operations to a trace file; requires the portable backend
+// Input:	Name of the trace file
+// Return:	A code indicating the results of starting the trace
+
+PUBLIC RETCODE MemTraceStop (void);
+
+// Purpose:	Ends recording the global manager's operations; MemTerm also ends it
+// Input:	No input
+// Return:	A code indicating the results of ending the trace
+
 PUBLIC RETCODE MemGetPattern (void * memory, char Pattern []);
 
 // Purpose:	Used to retrieve a pattern used to identify memory
@@ -66,8 +291,14 @@ PUBLIC RETCODE MemGetPattern (void * memory, char Pattern []);
 
 PUBLIC RETCODE MemSetPattern (void * memory, char Pattern []);
 
-// Purpose:	Used to associate a pattern to a memory variable
+// Purpose:	Used to associate a pattern to a memory variable of the global manager
 // Input:   Memory variable to associate with pattern, and pattern to assign
 // Return:  A code indicating the results of setting the pattern
 
+PUBLIC RETCODE MemHeapSetPattern (hHEAP Heap, void * memory, char Pattern []);
+
+// Purpose:	Used to associate a pattern to memory from a heap, under the heap's lock
+// Input:	A heap handle, or NULL for the global manager, memory variable to associate with pattern, and pattern to assign
+// Return:	A code indicating the results of setting the pattern
+
 #endif // MEMORY_H
\ No newline at end of file
@@ -0,0 +1,385 @@
+/********************************************************************
+*																	*
+*							Includes								*
+*																	*
+********************************************************************/
+
+#include "i_Memory.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+/********************************************************************
+*																	*
+*							Internals								*
+*																	*
+********************************************************************/
+
+// The C runtime's allocation entry points, served by the global manager once the shim is preloaded
+// (LD_PRELOAD) or linked ahead of the C runtime; MemInit runs on the first request
+
+PRIVATE int ShimState;	// Setup state of the manager
+PRIVATE pthread_key_t ShimKey;	// Key whose destructor returns an exiting thread's cached blocks
+PRIVATE MEM_TLS int ShimKnown;	// Calling thread is registered with the key
+
+// Return an exiting thread's cached blocks to the pool
+PRIVATE void ShimThreadExit (void * Unused)
+{
+	(void) Unused;
+
+	MemThreadTerm ();
+
+	ShimKnown = FALSE;	// A later destructor that frees registers again, so the cache it rebuilds is returned too
+}
+
+// Set up the manager on the first request; requests from other threads wait until it is done
+PRIVATE RETCODE ShimSetup (void)
+{
+	int Idle = SHIM_IDLE;	// State expected by the thread doing setup
+
+	if (__atomic_compare_exchange_n (&ShimState, &Idle, SHIM_BUSY, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+	{
+		uMCONFIG Config = {0};	// Configuration structure
+
+		Config.PoolSize = SHIM_POOL;// Pool grows until memory runs out, and returns idle segments
+		Config.PoolLimit = SHIM_LIMIT;
+		Config.Settings = MEM_THREADSAFE | MEM_TRIM;
+		Config.MapThreshold = SHIM_MAP;
+
+		if (MemInit (&Config) != RETCODE_SUCCESS || pthread_key_create (&ShimKey, ShimThreadExit) != 0)
+		{
+			__atomic_store_n (&ShimState, SHIM_DEAD, __ATOMIC_RELEASE);
+
+			return RETCODE_FAILURE;
+		}
+
+		__atomic_store_n (&ShimState, SHIM_LIVE, __ATOMIC_RELEASE);
+
+		pthread_atfork (MemForkPrepare, MemForkRelease, MemForkRelease);// May allocate, so the manager is live first
+	}
+
+	while ((Idle = __atomic_load_n (&ShimState, __ATOMIC_ACQUIRE)) == SHIM_BUSY)
+		sched_yield ();
+
+	return Idle == SHIM_LIVE ? RETCODE_SUCCESS : RETCODE_FAILURE;
+}
+
+// Ready the manager and the calling thread for a request
+PRIVATE RETCODE ShimReady (void)
+{
+	if (__atomic_load_n (&ShimState, __ATOMIC_ACQUIRE) != SHIM_LIVE && ShimSetup () != RETCODE_SUCCESS)
+		return RETCODE_FAILURE;
+
+	if (!ShimKnown)	// Have the thread's cache returned when it exits
+	{
+		ShimKnown = TRUE;	// Set first, as registration may allocate
+
+		pthread_setspecific (ShimKey, &ShimKnown);
+	}
+
+	return RETCODE_SUCCESS;
+}
+
+// Allocate at an alignment, which must be a power of two
+PRIVATE void * ShimAligned (size_t Alignment, size_t Size)
+{
+	void * memory;	// Allocated memory
+
+	if (Size > SHIM_LIMIT || Alignment > SHIM_LIMIT || ShimReady () != RETCODE_SUCCESS)
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	if (Alignment <= MEM_GRAIN)	// Every block meets the granularity
+		memory = MemAlloc (Size != 0 ? Size : 1, 0);
+
+	else memory = MemAllocAligned (Size != 0 ? Size : 1, Alignment, 0);
+
+	if (memory == NULL) errno = ENOMEM;
+
+	return memory;
+}
+
+/********************************************************************************
+*																				*
+*								malloc											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory of a given size
+// Input:	Block size
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * malloc (size_t Size)
+{
+	void * memory;	// Allocated memory
+
+	if (Size > SHIM_LIMIT || ShimReady () != RETCODE_SUCCESS)
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	memory = MemAlloc (Size != 0 ? Size : 1, 0);// Zero-byte requests still get a unique block
+
+	if (memory == NULL) errno = ENOMEM;
+
+	return memory;
+}
+
+/********************************************************************************
+*																				*
+*								free											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to release memory
+// Input:	Context to release, or NULL
+// Return:	No return value
+
+void free (void * memory)
+{
+	if (memory == NULL || ShimReady () != RETCODE_SUCCESS)	// Only a live manager handed out memory
+		return;
+
+	MemFree (memory);
+}
+
+/********************************************************************************
+*																				*
+*								calloc											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate zeroed memory for an array
+// Input:	Element count, and element size
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * calloc (size_t Count, size_t Size)
+{
+	void * memory;	// Allocated memory
+
+	if ((Size != 0 && Count > SHIM_LIMIT / Size) || ShimReady () != RETCODE_SUCCESS)	// Reject products that overflow
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	memory = MemAlloc (Count * Size != 0 ? Count * Size : 1, MEM_ZERO);
+
+	if (memory == NULL) errno = ENOMEM;
+
+	return memory;
+}
+
+/********************************************************************************
+*																				*
+*								realloc											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to resize memory, in place where the pool allows
+// Input:	Context to resize, or NULL to allocate, and new block size; 0 releases the context
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * realloc (void * memory, size_t Size)
+{
+	void * Resized;	// Resized memory
+
+	if (memory == NULL)	// Resizing nothing is allocation
+		return malloc (Size);
+
+	if (Size == 0)	// Resizing to nothing is release
+	{
+		free (memory);
+
+		return NULL;
+	}
+
+	if (Size > SHIM_LIMIT || ShimReady () != RETCODE_SUCCESS)
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	Resized = MemRealloc (memory, Size);
+
+	if (Resized == NULL) errno = ENOMEM;
+
+	return Resized;
+}
+
+/********************************************************************************
+*																				*
+*								reallocarray									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to resize memory holding an array
+// Input:	Context to resize, or NULL to allocate, element count, and element size
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * reallocarray (void * memory, size_t Count, size_t Size)
+{
+	if (Size != 0 && Count > SHIM_LIMIT / Size)	// Reject products that overflow
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	return realloc (memory, Count * Size);
+}
+
+/********************************************************************************
+*																				*
+*								posix_memalign									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory at a given alignment
+// Input:	Pointer to load, power-of-two alignment that is a multiple of pointer size, and block size
+// Return:	0 if successful; EINVAL for a bad alignment, or ENOMEM, leaving the pointer untouched
+
+int posix_memalign (void ** Result, size_t Alignment, size_t Size)
+{
+	void * memory;	// Allocated memory
+
+	int Error = errno;	// Failure is reported by return value alone
+
+	if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0 || Alignment % sizeof(void *) != 0)
+		return EINVAL;
+
+	memory = ShimAligned (Alignment, Size);
+
+	if (memory == NULL)
+	{
+		errno = Error;
+
+		return ENOMEM;
+	}
+
+	*Result = memory;
+
+	return 0;
+}
+
+/********************************************************************************
+*																				*
+*								aligned_alloc									*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory at a given alignment
+// Input:	Power-of-two alignment, and block size
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * aligned_alloc (size_t Alignment, size_t Size)
+{
+	if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0)
+	{
+		errno = EINVAL;
+
+		return NULL;
+	}
+
+	return ShimAligned (Alignment, Size);
+}
+
+/********************************************************************************
+*																				*
+*								memalign										*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate memory at a given alignment
+// Input:	Alignment, rounded up to a power of two, and block size
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * memalign (size_t Alignment, size_t Size)
+{
+	size_t Power = MEM_GRAIN;	// Alignment as a power of two
+
+	while (Power < Alignment && Power <= SHIM_LIMIT)
+		Power <<= 1;
+
+	return ShimAligned (Power, Size);
+}
+
+/********************************************************************************
+*																				*
+*								valloc											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate page-aligned memory
+// Input:	Block size
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * valloc (size_t Size)
+{
+	return ShimAligned (sysconf (_SC_PAGESIZE), Size);
+}
+
+/********************************************************************************
+*																				*
+*								pvalloc											*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to allocate page-aligned memory in whole pages
+// Input:	Block size, rounded up to a page
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * pvalloc (size_t Size)
+{
+	size_t Page = sysconf (_SC_PAGESIZE);	// System page size
+
+	if (Size > SHIM_LIMIT)
+	{
+		errno = ENOMEM;
+
+		return NULL;
+	}
+
+	return ShimAligned (Page, (Size + Page - 1) & ~(Page - 1));
+}
+
+/********************************************************************************
+*																				*
+*								malloc_usable_size								*
+*																				*
+********************************************************************************/	
+
+
+// Purpose:	Used to find how many bytes of a block may be used
+// Input:	Context of block, or NULL
+// Return:	Usable size, which is at least the size requested
+
+size_t malloc_usable_size (void * memory)
+{
+	ptMEMBLOCK MemBlock;// Block holding memory
+
+	if (memory == NULL)	// Nothing to measure
+		return 0;
+
+	MemBlock = (ptMEMBLOCK)((Pbyte) memory - BLOCK_SIZE);
+
+	return MemBlock->Size & ~(Dword)(MEM_USED | MEM_FENCE);	// Clears the marks of used and mapped blocks alike
+}
@@ -0,0 +1,128 @@
+/********************************************************************
+*																	*
+*							Includes								*
+*																	*
+********************************************************************/
+
+#include "i_Memory.h"
+
+/********************************************************************************
+*																				*
+*								MemSlabCreate									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Creates a slab cache handing out objects of one size
+// Input:	Per-object size, and objects per slab; 0 fits as many as a page holds
+// Return:	A handle to the new slab cache, if successful; NULL otherwise
+
+hSLAB MemSlabCreate (Dword SizeOfObject, Dword nPerSlab)
+{
+	ptSLAB Slab = (ptSLAB) MemAlloc (sizeof(tSLAB), MEM_ZERO);	// New slab cache
+
+	if (Slab == NULL)	// Ascertain that MemAlloc succeeded
+		return NULL;
+
+	if (SizeOfObject < sizeof(void *))	// Released objects must hold a link
+		SizeOfObject = sizeof(void *);
+
+	Slab->SizeOfObject = MEM_ROUND(SizeOfObject);	// Keep objects aligned to allocation granularity
+
+	if (nPerSlab == 0)	// Fit as many objects as a page holds, header included
+		nPerSlab = (SLAB_PAGE - BLOCK_SIZE - sizeof(void *)) / Slab->SizeOfObject;
+
+	if (nPerSlab < SLAB_MIN)// Large objects still come several to a slab
+		nPerSlab = SLAB_MIN;
+
+	Slab->SlabBytes = sizeof(void *) + nPerSlab * Slab->SizeOfObject;	// Slab link, then objects
+
+	return Slab;
+	// Return new slab cache
+}
+
+/********************************************************************************
+*																				*
+*								MemSlabDestroy									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Destroys a slab cache, along with all of its objects
+// Input:	A slab cache handle
+// Return:	A code indicating the results of the destruction
+
+RETCODE MemSlabDestroy (hSLAB Slab)
+{
+	while (Slab->Slabs != NULL)	// Release each slab; objects are never visited
+	{
+		void * Next = *(void **) Slab->Slabs;	// Refer to next slab in chain
+
+		MemFree (Slab->Slabs);
+
+		Slab->Slabs = Next;
+	}
+
+	MemFree (Slab);	// Release slab cache
+
+	return RETCODE_SUCCESS;
+	// Return success
+}
+
+/********************************************************************************
+*																				*
+*								MemSlabAlloc									*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to take an object from a slab cache
+// Input:	A slab cache handle
+// Return:	Pointer to the object, if successful; NULL otherwise
+
+void * MemSlabAlloc (hSLAB Slab)
+{
+	void * Object = Slab->Free;	// Object to hand out
+
+	if (Object != NULL)	// Reuse the most recently released object
+	{
+		Slab->Free = *(void **) Object;
+
+		return Object;
+	}
+
+	if (Slab->Fresh == Slab->Limit)	// Newest slab is used up, so chain a new one
+	{
+		Pbyte New = (Pbyte) MemAlloc (Slab->SlabBytes, 0);	// New slab
+
+		if (New == NULL)// Ascertain that MemAlloc succeeded
+			return NULL;
+
+		*(void **) New = Slab->Slabs;	// Link slab into chain
+		Slab->Slabs = New;
+
+		Slab->Fresh = New + sizeof(void *);	// Objects are carved lazily from the slab
+		Slab->Limit = New + Slab->SlabBytes;
+	}
+
+	Object = Slab->Fresh;	// Carve next never-used object
+
+	Slab->Fresh += Slab->SizeOfObject;
+
+	return Object;
+	// Return new object
+}
+
+/********************************************************************************
+*																				*
+*								MemSlabFree										*
+*																				*
+********************************************************************************/	
+
+// Purpose:	Used to release an object to a slab cache
+// Input:	A slab cache handle, and object to release
+// Return:	No return value
+
+void MemSlabFree (hSLAB Slab, void * Object)
+{
+	*(void **) Object = Slab->Free;	// Push object onto released objects
+
+	Slab->Free = Object;
+}
@@ -12,13 +12,92 @@
 
 #include "Memory.h"
 
+/********************************************************************
+*																	*
+*							Backend									*
+*																	*
+********************************************************************/
+
+// The naked-asm path requires 32-bit VCC; everywhere else, or when MEM_PORTABLE
+// is defined on the command line, the allocator is built from portable C
+
+#if !defined(MEM_PORTABLE) && !(defined(_MSC_VER) && defined(_M_IX86))
+	#define MEM_PORTABLE
+#endif
+
+// MEM_SHIM builds the allocator to stand in for the C runtime's own, as the interposition
+// shim does: blocks meet the C runtime's alignment, and the manager's storage bypasses it
+
+#if defined(MEM_SHIM) && !defined(MEM_PORTABLE)
+	#error MEM_SHIM requires the portable backend
+#endif
+
+#ifdef MEM_PORTABLE
+	#ifdef _WIN32
+		typedef CRITICAL_SECTION MEMLOCK;	// Lock guarding a shared manager
+
+		#define MEM_TLS	__declspec(thread)	// Thread-local storage
+
+		#define MemMapPages(bytes)			VirtualAlloc(NULL, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)
+		#define MemUnmapPages(pages,bytes)	VirtualFree(pages, 0, MEM_RELEASE)
+
+		#define MemThreadId()	GetCurrentThreadId()	// Identifier of the calling thread
+
+		#define MemLockInit(lock)	InitializeCriticalSection(lock)
+		#define MemLockTerm(lock)	DeleteCriticalSection(lock)
+		#define MemLock(lock)		EnterCriticalSection(lock)
+		#define MemUnlock(lock)		LeaveCriticalSection(lock)
+
+		#define MemTally(counter,n)	InterlockedExchangeAdd((LONG volatile *) (counter), (LONG) (n))	// Adjust a counter only its owner writes
+		#define MemPeek(counter)	(*(Dword volatile *) (counter))	// Read a counter another thread writes
+	#else
+		#include <pthread.h>
+		#include <sys/mman.h>
+		#include <time.h>
+
+		typedef pthread_mutex_t MEMLOCK;	// Lock guarding a shared manager
+
+		#define MEM_TLS	__thread	// Thread-local storage
+
+		#define MemMapPages(bytes)			MemMapAnonymous(bytes)
+		#define MemUnmapPages(pages,bytes)	munmap(pages, bytes)
+
+		#define MemThreadId()	((Dword)(size_t) pthread_self())	// Identifier of the calling thread
+
+		#define MemLockInit(lock)	pthread_mutex_init(lock, NULL)
+		#define MemLockTerm(lock)	pthread_mutex_destroy(lock)
+		#define MemLock(lock)		pthread_mutex_lock(lock)
+		#define MemUnlock(lock)		pthread_mutex_unlock(lock)
+
+		#define MemTally(counter,n)	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED)	// Adjust a counter only its owner writes
+		#define MemPeek(counter)	__atomic_load_n(counter, __ATOMIC_RELAXED)	// Read a counter another thread writes
+	#endif
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+
+		#define MemCaller()	_ReturnAddress()	// Return address of the calling function
+	#else
+		#define MemCaller()	__builtin_return_address(0)	// Return address of the calling function
+	#endif
+
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+
+		#define MEM_SSE2	// Clears use 16-byte vector stores
+	#endif
+#endif
+
 /********************************************************************
 *																	*
 *							Flags									*
 *																	*
 ********************************************************************/
 
-#define MEM_USED 0x1	// Used memory
+#define MEM_USED  0x1	// Used memory
+#define MEM_FENCE 0x2	// Fence bounding a pool segment; always marked used
+#define MEM_DIRECT (MEM_USED | MEM_FENCE)	// Block mapped on pages of its own; marked as a fence, but never chained
+#define MEM_DEFERRED MEM_FENCE	// Deferred block while a map is written; a fence never goes unused
 
 /********************************************************************
 *																	*
@@ -26,6 +105,8 @@
 *																	*
 ********************************************************************/
 
+#ifndef MEM_PORTABLE
+
 /* tMEMBLOCK offsets */
 #define _Prev  0x00	// Prev offset
 #define _Next  0x04	// Next offset
@@ -39,11 +120,117 @@
 /* tMEMBLOCK size */
 #define BLOCK_SIZE _DATA	// Data begins at end of block
 
+/* Size granularity */
+#define MEM_GRAIN	0x4	// Requests are rounded to dwords
+
+/* Size classes */
+#define SMALL_LIMIT	0x80	// Sizes below this limit have an exact bin
+#define LARGE_SHIFT	7		// Bit index of limit; first power-of-two bin holds [2^7, 2^8)
+
 /* mMEMORY offsets */
-#define _Pool	 0x0 // Pool offset
-#define _Cache	 0x4 // Cache offset
-#define _nUsed	 0x8 // nUsed offset
-#define _nUnused 0xC // nUnused offset
+#define _Pool	 0x00 // Pool offset
+#define _nUsed	 0x04 // nUsed offset
+#define _nUnused 0x08 // nUnused offset
+#define _BinMap	 0x0C // BinMap offset
+#define _Bins	 0x14 // Bins offset
+
+#else // MEM_PORTABLE
+
+/* tMEMBLOCK size */
+#define BLOCK_SIZE sizeof(tMEMBLOCK)	// Data begins at end of block
+
+/* Size granularity */
+#ifndef MEM_SHIM
+	#define MEM_GRAIN	sizeof(void *)	// Requests are rounded to pointer size, keeping headers aligned
+#else
+	#define MEM_GRAIN	0x10	// Requests are rounded to 16 bytes, as malloc's callers expect of their data
+#endif
+
+/* Size classes */
+#define SMALL_LIMIT	(SMALL_BINS * MEM_GRAIN)// Sizes below this limit have an exact bin
+#define LARGE_SHIFT	(MEM_GRAIN == 16 ? 9 : MEM_GRAIN == 8 ? 8 : 7)	// Bit index of limit
+
+#endif // MEM_PORTABLE
+
+#define SMALL_BINS	0x20	// Count of exact bins; one per grain multiple below limit
+#define NUM_BINS	MEM_HISTOGRAM	// Total count of bins; the last bin also holds any larger blocks
+
+/* Placement */
+#define SCAN_LIMIT	0x40	// Most free blocks a bin scan or an address-ordered insertion examines before settling
+
+/* Thread caches */
+#define CACHE_DEPTH	0x20	// Default count of blocks a thread may cache per size class
+
+/* Slabs */
+#define SLAB_PAGE	0x1000	// By default, a slab and its block header fill one page
+#define SLAB_MIN	8		// Least count of objects per slab
+
+/* Clears */
+#define MEM_WIDE	0x100	// Clears at least this large use vector stores
+#define MEM_STREAM	0x40000	// Clears at least this large bypass the cache
+
+/* Guard mode */
+#define MEM_CANARY	0xFD	// Fill between a request's end and its trailer key
+#define MEM_POISON	0xDD	// Fill of released memory, and of its block's pattern
+#define GUARD_BYTES	(sizeof(Dword) + 1)	// Trailer: at least one canary byte, then the keyed request size
+#define GUARD_KEY	0x5AFEC0DE	// Mixed with a block's address to key its request size
+#define QUARANTINE_DEPTH 0x40	// Count of released blocks each heap holds back from reuse
+
+/* Allocation sites */
+#define SITE_BIT	(1ULL << 63)	// Marks a pattern holding a return address; text patterns are 7-bit
+
+/* Interposition shim */
+#define SHIM_POOL	0x1000000	// Initial pool of the manager standing in for the C runtime
+#define SHIM_MAP	0x20000		// Its requests of at least this many bytes get pages of their own
+#define SHIM_LIMIT	((Dword) -1 >> 1)	// Larger requests fail outright, ahead of any rounding overflow
+
+#define SHIM_IDLE	0	// Manager not yet set up
+#define SHIM_BUSY	1	// Manager being set up by the first caller
+#define SHIM_LIVE	2	// Manager serving requests
+#define SHIM_DEAD	3	// Manager failed to set up; requests fail
+
+/* Pool growth */
+#define MEM_PAGE	0x10000	// Growth segments are mapped in multiples of this size
+#define GROWTH_RATE	100		// Default growth, as a percentage of the current pool
+#define MAP_PAGE	0x1000	// Blocks with pages of their own are mapped in multiples of this size
+
+/********************************************************************
+*																	*
+*							Macros									*
+*																	*
+********************************************************************/
+
+// Round a request up to the allocation granularity
+#define MEM_ROUND(size)	(((size) + MEM_GRAIN - 1) & ~(Dword)(MEM_GRAIN - 1))
+
+// Whether the calling thread's operations on the global manager are traced, short of writing a record
+#define MEM_TRACING()	(MemPeek(&MemTraceLive) != 0 && !MemTraceBusy)
+
+// Key a heap's new block is stamped with: the return address of the calling function, if the heap records sites
+#define MEM_SITE(heap)	((heap)->Settings & MEM_CALLSITES ? (size_t) MemCaller() | SITE_BIT : 0ULL)
+
+// Link of a block in a thread cache, kept in its data so that its pattern is never written outside the lock
+#define MEM_LINK(block)	(*(ptMEMBLOCK *) &(block) [BASE_EXTENT])
+
+// Start of the pages a mapped block heads; an aligned block's header lies within the first page
+#define MAP_BASE(block)	((Pbyte)(block) - ((size_t)(block) & (MAP_PAGE - 1)))
+
+// Acquire and release the manager's own storage, its pool and thread caches; mapped pages
+// stand in for the C runtime when the manager replaces it
+#ifndef MEM_SHIM
+	#define MemSysAlloc(bytes)			calloc(1, bytes)
+	#define MemSysFree(memory,bytes)	free(memory)
+#else
+	#define MemSysAlloc(bytes)			MemMapPages(bytes)
+	#define MemSysFree(memory,bytes)	MemUnmapPages(memory, bytes)
+#endif
+
+// Test whether a heap's bin is marked non-empty
+#ifndef MEM_PORTABLE
+	#define MEM_BINBIT(heap,bin)	((heap)->BinMap [(bin) >> 5] >> ((bin) & 31) & 1)
+#else
+	#define MEM_BINBIT(heap,bin)	((heap)->BinMap >> (bin) & 1)
+#endif
 
 /********************************************************************
 *																	*
@@ -68,6 +255,9 @@ typedef struct _tMEMBLOCK {
 			Byte Pattern [8];	// Pattern used to identify memory
 		};	// End-struct
 	};	// End-union
+#ifdef MEM_SHIM
+	Dword Pad [(0x10 - (4 * sizeof(void *) + sizeof(Dword)) % 0x10) / sizeof(Dword)];	// Pads header to the grain
+#endif
 	Dword Size;		// Size of memory block in bytes
 	/* Byte Data []: Virtual byte stream */
 } tMEMBLOCK, * ptMEMBLOCK;
@@ -78,17 +268,90 @@ typedef struct _tMEMBLOCK {
 
 typedef struct _mMEMORY {
 	ptMEMBLOCK Pool;	// Main memory pool
-	ptMEMBLOCK Cache;	// Cache of unused memory blocks
 	Dword nUsed;		// Count of used memory blocks
 	Dword nUnused;		// Count of unused memory blocks
+#ifndef MEM_PORTABLE
+	Dword BinMap [2];	// Bitmap of non-empty bins
+#else
+	unsigned long long BinMap;	// Bitmap of non-empty bins
+#endif
+	ptMEMBLOCK Bins [NUM_BINS];	// Size-segregated rings of unused memory blocks
+#ifdef MEM_PORTABLE
+	FLAGS Settings;		// Manager settings
+	Dword CacheDepth;	// Blocks each thread may cache per size class
+	struct _tMEMCACHE * Caches;	// Registry of thread caches
+	MEMLOCK Lock;		// Lock guarding pool in thread-safe mode
+	ptMEMBLOCK Segments;// Head fences of growth segments, linked through pFree and nFree
+	Dword PoolBytes;	// Bytes in initial pool and growth segments
+	Dword PoolLimit;	// Ceiling on pool bytes
+	Dword GrowthRate;	// Growth, as a percentage of the current pool
+	Dword Placement;	// Placement policy
+	Pbyte Clean;		// Start of never-used memory, known to be zero
+	Pbyte CleanEnd;		// End of never-used memory
+	Pbyte Stale;		// End of bytes that may be non-zero in the last block split
+	Dword nSegments;	// Count of growth segments
+	Dword FreeBytes;	// Bytes in free blocks, headers excluded
+	Dword PeakBytes;	// Most bytes ever in used blocks
+	unsigned long long nSearches;	// Count of searches for a fitting block
+	unsigned long long nSteps;		// Count of free blocks examined in searches
+	Dword Histogram [NUM_BINS];		// Requests carved out of the pool, per bin
+	ptMEMBLOCK Quarantine [QUARANTINE_DEPTH];	// Ring of released blocks held back from reuse in guard mode
+	Dword QuarantineNext;	// Quarantine slot to fill next; it holds the oldest block
+	Dword MapThreshold;	// Requests of at least this many bytes get pages of their own; 0 if none do
+	ptMEMBLOCK Direct;	// Blocks mapped on pages of their own, linked through Prev and Next
+	Dword nDirect;		// Count of mapped blocks
+	Dword DirectBytes;	// Bytes in mapped blocks, headers excluded
+	ptMEMBLOCK Quick [SMALL_BINS];	// Per-class stacks of released blocks awaiting coalescing, linked through pFree
+	Dword nQuick;		// Count of blocks awaiting coalescing
+	Dword QuickBytes;	// Bytes in blocks awaiting coalescing, headers excluded
+#endif
 } mMEMORY, * pmMEMORY;
 
+/////////////////////////////////////////////////
+// _tSLAB: Cache of identically sized objects //
+/////////////////////////////////////////////////
+
+typedef struct _tSLAB {
+	void * Free;	// Released objects, linked through their first word
+	void * Slabs;	// Slabs owned by cache, linked through their first word
+	Pbyte Fresh;	// Next never-used object in newest slab
+	Pbyte Limit;	// End of newest slab
+	Dword SizeOfObject;	// Per-object size, rounded to allocation granularity
+	Dword SlabBytes;	// Bytes allocated per slab
+} tSLAB, * ptSLAB;
+
+#ifdef MEM_PORTABLE
+
+///////////////////////////////////////////////////////////
+// _tMEMCACHE: Thread-local magazine of small used blocks //
+///////////////////////////////////////////////////////////
+
+typedef struct _tMEMCACHE * fMEMCACHE;	// Forward reference
+typedef struct _tMEMCACHE {
+	ptMEMBLOCK Slots [SMALL_BINS];	// Per-class stacks of cached blocks, linked through MEM_LINK
+	Dword Counts [SMALL_BINS];		// Per-class count of cached blocks
+	Dword nBlocks;	// Count of cached blocks, adjusted through MemTally
+	Dword Bytes;	// Bytes in cached blocks, headers excluded, adjusted through MemTally
+	fMEMCACHE Prev;	// Last cache in registry
+	fMEMCACHE Next;	// Next cache in registry
+} tMEMCACHE, * ptMEMCACHE;
+
+#endif // MEM_PORTABLE
+
 /********************************************************************
 *																	*
 *							Implementation							*
 *																	*
 ********************************************************************/
 
+#ifndef MEM_PORTABLE
+
+void MemBinIndex (void);
+
+// Purpose:	Used to find the bin that holds blocks of a given size
+// Input:	EAX : Block size
+// Return:	ECX : Bin index
+
 void MemRemoveFromFreeBlocks (void);
 
 // Purpose:	Used to extract a block from the free blocks
@@ -101,10 +364,263 @@ void MemInsertIntoFreeBlocks (void);
 // Input:	ESI : Memory block to insert
 // Return:	No return value
 
-long MemAdjoinBlocks (void);
+void MemAdjoinBlocks (void);
 
 // Purpose:	Used to adjoin memory
 // Input:	ESI : Memory block to adjoin
-// Return:	Amount of non-adjoinments
+// Return:	ESI : Block resulting from adjoinment
+
+#else // MEM_PORTABLE
+
+void MemHeapSetup (pmMEMORY Heap, puMCONFIG Config);
+
+// Purpose:	Used to load a heap's settings and free its initial pool
+// Input:	Heap with linked pool, and pointer to a configuration structure
+// Return:	No return value
+
+void * MemAllocKeyed (pmMEMORY Heap, Dword numBytes, FLAGS Options, unsigned long long Key);
+
+// Purpose:	Used to allocate memory of a given size from a heap, stamping its block with a key
+// Input:	Heap, block size, options, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+void * MemReallocKeyed (pmMEMORY Heap, void * memory, Dword numBytes, unsigned long long Key);
+
+// Purpose:	Used to resize memory from a heap, in place where the heap allows
+// Input:	Heap, context to resize, or NULL to allocate a block stamped with the key, new block size, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise, leaving the context intact
+
+void * MemAllocAlignedKeyed (pmMEMORY Heap, Dword numBytes, Dword Alignment, FLAGS Options, unsigned long long Key);
+
+// Purpose:	Used to allocate memory of a given size at a given alignment from a heap, stamping its block with a key
+// Input:	Heap, block size, power-of-two alignment, options, and key
+// Return:	Pointer to the memory, if successful; NULL otherwise
+
+ptMEMBLOCK MemTakeBlock (pmMEMORY Heap, Dword Size, unsigned long long Key);
+
+// Purpose:	Used to carve a used block out of the free blocks, stamping it with a key while the lock is held
+// Input:	Heap, size of request, rounded to allocation granularity, and key
+// Return:	Used block, if successful; NULL otherwise
+
+void MemSplitBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Size);
+
+// Purpose:	Used to mark a block used, splitting off any padding past a request as a free block, and
+//			to record how much of it may be non-zero
+// Input:	Heap, block outside the free blocks, and size of request, rounded to allocation granularity
+// Return:	No return value
+
+void MemTouchBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to record how much of a used block may be non-zero, and to move never-used memory past it
+// Input:	Heap, and used block
+// Return:	No return value
+
+void MemClearBlock (ptMEMBLOCK MemBlock, Pbyte Stale);
+
+// Purpose:	Used to zero out a used block's memory, skipping what is known to be zero
+// Input:	Used block, and end of bytes that may be non-zero, or NULL if unknown
+// Return:	No return value
+
+RETCODE MemResizeBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Size);
+
+// Purpose:	Used to resize a used block in place, absorbing a free successor to grow
+// Input:	Heap, used block to resize, and new size, rounded to allocation granularity
+// Return:	A code indicating whether the block could be resized in place
+
+ptMEMBLOCK MemAlignBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock, Dword Alignment);
+
+// Purpose:	Used to move a used block's data up to an alignment, returning the leading slack as a free block
+// Input:	Heap, used block with room for the alignment, and power-of-two alignment
+// Return:	Aligned used block
+
+Dword MemUsedBytes (pmMEMORY Heap);
+
+// Purpose:	Used to compute the bytes in a heap's used blocks
+// Input:	Heap
+// Return:	Bytes in used blocks, headers excluded
+
+void MemGiveBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to return a used block to the free blocks
+// Input:	Heap, and used block to release
+// Return:	No return value
+
+void MemDeferBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to return a used block to the pool, holding small blocks back from coalescing in deferred mode
+// Input:	Heap, and used block to release
+// Return:	No return value
+
+void MemCompactHeap (pmMEMORY Heap);
+
+// Purpose:	Used to coalesce every deferred block into the free blocks; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+void MemFlipDeferred (pmMEMORY Heap);
+
+// Purpose:	Used to mark every deferred block as such, or to restore them as used; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+ptMEMBLOCK MemFindBlock (pmMEMORY Heap, Dword Size);
+
+// Purpose:	Used to find a free block that fits a request
+// Input:	Heap, and size of request, rounded to allocation granularity
+// Return:	Fitting block, if any; NULL otherwise
+
+ptMEMBLOCK MemScanBin (pmMEMORY Heap, Dword Bin, Dword Size, Dword Limit);
+
+// Purpose:	Used to pick a fitting block out of a non-empty bin, according to the placement policy
+// Input:	Heap, bin to scan, size of request, rounded to allocation granularity, and most blocks to examine
+// Return:	Fitting block, if any; NULL otherwise
+
+RETCODE MemGrowPool (pmMEMORY Heap, Dword Size);
+
+// Purpose:	Used to chain a new segment onto a heap's pool
+// Input:	Heap, and size of request the segment must satisfy
+// Return:	A code indicating the results of the growth
+
+void MemTrimPool (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to return a segment to the system if a free block spans all of it
+// Input:	Heap, and free block to test
+// Return:	No return value
+
+void MemReleaseSegments (pmMEMORY Heap);
+
+// Purpose:	Used to return all of a heap's growth segments and mapped blocks to the system
+// Input:	Heap
+// Return:	No return value
+
+RETCODE MemSplitBatch (pmMEMORY Heap, Dword Size, Dword Count, void * Blocks [], unsigned long long Key);
+
+// Purpose:	Used to carve one block for a batch and divide it into used blocks of one size, each stamped with a key
+// Input:	Heap, size of each request, rounded to allocation granularity, count of blocks, array to load, and key
+// Return:	A code indicating whether the batch was carved
+
+ptMEMBLOCK MemMapBlock (pmMEMORY Heap, Dword Size, Dword Alignment, unsigned long long Key);
+
+// Purpose:	Used to map a used block on pages of its own, outside the pool, stamped with a key before it is linked
+// Input:	Heap, size of request, rounded to allocation granularity, power-of-two alignment, at most a page, and key
+// Return:	Used block, if successful; NULL otherwise
+
+void MemUnmapBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to return a mapped block's pages to the system
+// Input:	Heap, and mapped block
+// Return:	No return value
+
+void MemGuardBlock (ptMEMBLOCK MemBlock, Dword numBytes);
+
+// Purpose:	Used to write a used block's trailer: canary bytes past the request, then its keyed size
+// Input:	Used block, and size of request
+// Return:	No return value
+
+Dword MemGuardCheck (ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to validate a used block's links and trailer, aborting on damage
+// Input:	Used block
+// Return:	Size of request
+
+ptMEMBLOCK MemQuarantineBlock (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to validate and poison a released block, holding it back in place of the oldest one
+// Input:	Heap, and used block to release
+// Return:	Oldest block, now due for release, if the quarantine was full; NULL otherwise
+
+void MemDrainQuarantine (pmMEMORY Heap);
+
+// Purpose:	Used to release every quarantined block to the free blocks; lock must be held
+// Input:	Heap
+// Return:	No return value
+
+void MemGuardFault (ptMEMBLOCK MemBlock, char const * Fault);
+
+// Purpose:	Used to report damage to a block and abort
+// Input:	Damaged block, and description of the damage
+// Return:	No return value
+
+void MemSetKey (ptMEMBLOCK MemBlock, unsigned long long Key);
+
+// Purpose:	Used to load a used block's pattern with its key: a marked allocation site, pattern bytes, or 0
+// Input:	Used block, and key
+// Return:	No return value
+
+BOOL MemIsHeld (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to tell whether a used block is held in quarantine
+// Input:	Heap, and used block
+// Return:	Whether the block is held
+
+ptMEMBLOCK MemCacheAlloc (Dword Size);
+
+// Purpose:	Used to take a small block from the calling thread's cache of the global heap, refilling it if empty
+// Input:	Size of request, rounded to allocation granularity
+// Return:	Used block, if successful; NULL otherwise
+
+void MemCacheFree (ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to put an unkeyed block into the calling thread's cache of the global heap, flushing it if full
+// Input:	Used block to release
+// Return:	No return value
+
+void MemCacheFlush (ptMEMCACHE Cache);
+
+// Purpose:	Used to return all of a cache's blocks to the free blocks; lock must be held
+// Input:	Cache to flush
+// Return:	No return value
+
+void MemTraceRecord (Dword Op, Dword Size, FLAGS Options, Dword Alignment, void const * Address, unsigned long long Prior);
+
+// Purpose:	Used to append an operation to the trace file under the trace lock
+// Input:	Traced operation, request size, options, alignment, block operated on, and prior block or pattern
+// Return:	No return value
+
+void MemTraceWrite (Dword Op, Dword Size, FLAGS Options, Dword Alignment, void const * Address, unsigned long long Prior);
+
+// Purpose:	Used to append an operation to the trace file, if a trace is still running; lock must be held
+// Input:	Traced operation, request size, options, alignment, block operated on, and prior block or pattern
+// Return:	No return value
+
+Dword MemBinIndex (Dword Size);
+
+// Purpose:	Used to find the bin that holds blocks of a given size
+// Input:	Block size
+// Return:	Bin index
+
+void MemRemoveFromFreeBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to extract a block from the free blocks
+// Input:	Heap, and memory block to extract
+// Return:	No return value
+
+ptMEMBLOCK MemInsertIntoFreeBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to place a block within the free blocks
+// Input:	Heap, and memory block to insert
+// Return:	Block resulting from adjoinment
+
+ptMEMBLOCK MemAdjoinBlocks (pmMEMORY Heap, ptMEMBLOCK MemBlock);
+
+// Purpose:	Used to adjoin memory
+// Input:	Heap, and memory block to adjoin
+// Return:	Block resulting from adjoinment
+
+#ifdef MEM_SHIM
+void MemForkPrepare (void);
+
+// Purpose:	Used to hold the global manager still across fork, so the child inherits its lock unheld
+// Input:	No input
+// Return:	No return value
+
+void MemForkRelease (void);
+
+// Purpose:	Used to release the global manager after fork, in both parent and child
+// Input:	No input
+// Return:	No return value
+#endif
+
+#endif // MEM_PORTABLE
 
 #endif // I_MEMORY_H
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "common.h"
+
+#include "Memory/Memory.h"
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define REPLAY_MALLINFO	// Heap footprint of the C runtime is observable
+#endif
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#define REPLAY_NONE	((Dword) ~0)	// Record refers to no replayed object
+
+uMTRACE * Trace;// Records of captured trace
+Dword * Object;	// Object operated on by each record
+Dword * Size;	// Current request size of each object
+void ** Live;	// Memory held by each object during a replay
+Dword nRecords, nObjects;	// Counts of records and objects
+
+unsigned long long * Keys;	// Addresses in the object map
+Dword * Values;	// Objects in the object map
+Dword Mask;	// Object map capacity, less one
+
+char const * Policies [] = { "first fit", "next fit", "best fit", "address fit" };	// Names of placement policies
+
+double Seconds (void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER C, F;	// Profiling variables
+
+	QueryPerformanceCounter (&C);
+	QueryPerformanceFrequency (&F);
+
+	return (double) C.QuadPart / (double) F.QuadPart;
+#else
+	struct timespec Now;// Monotonic time
+
+	clock_gettime (CLOCK_MONOTONIC, &Now);
+
+	return (double) Now.tv_sec + (double) Now.tv_nsec * 1e-9;
+#endif
+}
+
+Dword * Map (unsigned long long Address)
+{
+	Dword slot = (Dword)((Address >> 4) * 0x9E3779B1) & Mask;	// Probe start
+
+	/* Addresses are reused after release, so a slot maps the block's latest object */
+	while (Keys [slot] != 0 && Keys [slot] != Address) slot = (slot + 1) & Mask;
+
+	Keys [slot] = Address;
+
+	return Values + slot;
+}
+
+Dword Prepare (Dword * PeakLive)
+{
+	unsigned long long LiveBytes = 0, MostBytes = 0;// Live request bytes
+	Dword index, peak = 0, * Entry;	// Loop variable, record at peak, and map entry
+
+	for (Mask = 1; Mask < nRecords * 2; Mask <<= 1);
+
+	Keys = (unsigned long long *) calloc (Mask, sizeof(unsigned long long));
+	Values = (Dword *) malloc (Mask * sizeof(Dword));
+	Object = (Dword *) malloc (nRecords * sizeof(Dword));
+	Size = (Dword *) malloc (nRecords * sizeof(Dword));
+
+	memset (Values, 0xFF, Mask * sizeof(Dword));	// Unknown blocks map to no object
+
+	--Mask;
+
+	/* Number the objects, skipping failed requests and blocks allocated before the trace began */
+	for (index = 0; index < nRecords; ++index)
+	{
+		uMTRACE * Record = Trace + index;	// Current record
+
+		Object [index] = REPLAY_NONE;
+
+		if (Record->Op == MEM_TRACE_REALLOC && Record->Prior != 0)
+		{
+			Entry = Map (Record->Prior);
+
+			if (*Entry == REPLAY_NONE || Record->Address == 0) continue;
+
+			Object [index] = *Entry;
+
+			LiveBytes = LiveBytes - Size [*Entry] + Record->Size;
+			Size [*Entry] = Record->Size;
+
+			*Entry = REPLAY_NONE;
+			*Map (Record->Address) = Object [index];
+		}
+
+		else if (Record->Op == MEM_TRACE_ALLOC || Record->Op == MEM_TRACE_REALLOC)
+		{
+			if (Record->Address == 0) continue;
+
+			Object [index] = nObjects;
+			Size [nObjects] = Record->Size;
+
+			LiveBytes += Record->Size;
+
+			*Map (Record->Address) = nObjects++;
+		}
+
+		else
+		{
+			Entry = Map (Record->Address);
+
+			Object [index] = *Entry;
+
+			if (Record->Op == MEM_TRACE_FREE && *Entry != REPLAY_NONE)
+			{
+				LiveBytes -= Size [*Entry];
+
+				*Entry = REPLAY_NONE;
+			}
+		}
+
+		if (LiveBytes > MostBytes) MostBytes = LiveBytes, peak = index;
+	}
+
+	*PeakLive = (Dword) MostBytes;
+
+	return peak;
+}
+
+void Run (Dword From, Dword To, int bCRT)
+{
+	Dword index;// Loop variable
+
+	for (index = From; index < To; ++index)
+	{
+		uMTRACE * Record = Trace + index;	// Current record
+		Dword Which = Object [index];	// Object operated on
+
+		if (Which == REPLAY_NONE) continue;
+
+		switch (Record->Op)
+		{
+		case MEM_TRACE_ALLOC:
+			if (bCRT) Live [Which] = Record->Options & MEM_ZERO ? calloc (1, Record->Size) : malloc (Record->Size);
+
+			else if (Record->Shift != 0) Live [Which] = MemAllocAligned (Record->Size, 1 << Record->Shift, Record->Options);
+
+			else Live [Which] = MemAlloc (Record->Size, Record->Options);
+
+			break;
+		case MEM_TRACE_REALLOC:
+			Live [Which] = bCRT ? realloc (Live [Which], Record->Size) : MemRealloc (Live [Which], Record->Size);
+
+			break;
+		case MEM_TRACE_FREE:
+			if (Live [Which] == NULL) break;
+
+			if (bCRT) free (Live [Which]);
+
+			else MemFree (Live [Which]);
+
+			Live [Which] = NULL;
+
+			break;
+		case MEM_TRACE_PATTERN:
+			if (!bCRT && Live [Which] != NULL)
+			{
+				char Pattern [9] = {0};	// Pattern bytes, terminated
+
+				memcpy (Pattern, &Record->Prior, 8);
+
+				MemSetPattern (Live [Which], Pattern);
+			}
+
+			break;
+		}
+	}
+}
+
+void Release (int bCRT)
+{
+	Dword index;// Loop variable
+
+	for (index = 0; index < nObjects; ++index)
+	{
+		if (Live [index] == NULL) continue;
+
+		if (bCRT) free (Live [index]);
+
+		else MemFree (Live [index]);
+
+		Live [index] = NULL;
+	}
+}
+
+int main (int argc, char * argv [])
+{
+	uMCONFIG M = {0};	// Configuration structure
+	uMSTATS Stats;	// Memory statistics at peak
+	Dword PeakLive, peak;	// Live request bytes and record at peak
+	double Start, seconds;	// Profiling variables
+	long Bytes;	// Size of trace file
+	FILE * fp;	// Trace file
+#ifdef REPLAY_MALLINFO
+	struct mallinfo2 Base, Info;	// C runtime statistics before replay and at peak
+#endif
+
+	if (argc < 2)
+	{
+		printf ("Usage: Replay trace [PoolSize [Placement]]\n");
+
+		return 1;
+	}
+
+	/* Load trace; replay bookkeeping stays out of the managers being measured */
+	fp = fopen (argv [1], "rb");
+
+	if (fp == NULL)
+	{
+		printf ("Unable to open %s\n", argv [1]);
+
+		return 1;
+	}
+
+	fseek (fp, 0, SEEK_END);
+	Bytes = ftell (fp);
+	fseek (fp, 0, SEEK_SET);
+
+	nRecords = (Dword)(Bytes / sizeof(uMTRACE));
+	Trace = (uMTRACE *) malloc (nRecords * sizeof(uMTRACE) + 1);
+
+	nRecords = (Dword) fread (Trace, sizeof(uMTRACE), nRecords, fp);
+
+	fclose (fp);
+
+	peak = Prepare (&PeakLive);
+
+	Live = (void **) calloc (nObjects + 1, sizeof(void *));
+
+	printf ("%lu records, %lu objects, peak live %lu bytes\n", (unsigned long) nRecords, (unsigned long) nObjects, (unsigned long) PeakLive);
+
+	/* Replay against MemMgr, pausing at the peak to sample statistics; the pool grows on demand */
+	M.PoolSize = argc > 2 ? strtoul (argv [2], NULL, 0) : 1 << 20;
+	M.PoolLimit = 1 << 30;
+	M.Placement = argc > 3 ? atoi (argv [3]) : MEM_FIRST_FIT;
+
+	if (MemInit (&M) != RETCODE_SUCCESS)
+	{
+		printf ("Unable to initialize memory\n");
+
+		return 1;
+	}
+
+	Start = Seconds ();
+	Run (0, peak + 1, 0);
+	seconds = Seconds () - Start;
+
+	MemGetStats (NULL, &Stats);
+
+	Start = Seconds ();
+	Run (peak + 1, nRecords, 0);
+	seconds += Seconds () - Start;
+
+	printf ("MemMgr (%s): %f seconds, %.1f ns/op\n", Policies [M.Placement & 3], seconds, seconds * 1e9 / nRecords);
+	printf ("\tpeak used %lu bytes, pool %lu bytes, fragmentation %.3f at peak\n", (unsigned long) Stats.PeakBytes, (unsigned long) Stats.PoolBytes, Stats.Fragmentation);
+
+	Release (0);
+
+	MemTerm (NULL);
+
+	/* Replay against the C runtime; its statistics also count the replay bookkeeping, so measure from a base */
+#ifdef REPLAY_MALLINFO
+	Base = mallinfo2 ();
+#endif
+
+	Start = Seconds ();
+	Run (0, peak + 1, 1);
+	seconds = Seconds () - Start;
+
+#ifdef REPLAY_MALLINFO
+	Info = mallinfo2 ();
+#endif
+
+	Start = Seconds ();
+	Run (peak + 1, nRecords, 1);
+	seconds += Seconds () - Start;
+
+	printf ("malloc: %f seconds, %.1f ns/op\n", seconds, seconds * 1e9 / nRecords);
+
+#ifdef REPLAY_MALLINFO
+	printf ("\tpeak used %lu bytes, arena %lu bytes at peak\n", (unsigned long)(Info.uordblks + Info.hblkhd - Base.uordblks - Base.hblkhd), (unsigned long)(Info.arena + Info.hblkhd - Base.arena - Base.hblkhd));
+#endif
+
+	Release (1);
+
+	return 0;
+}
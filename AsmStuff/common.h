@@ -8,11 +8,14 @@
 ********************************************************************/
 
 // Windows-specific
+#ifdef _WIN32
 #include <windows.h>
 #include <windowsx.h>
+#endif
 // Basic routines
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /********************************************************************
 *																	*
@@ -24,7 +27,11 @@
 #define PROTECTED			// Semantic used to indicate methods shared among implementations
 #define PRIVATE		static	// Semantic used to indicate implementation-specific attributes and methods
 
+#ifdef _MSC_VER
 #define QUICK	_declspec(naked)	// Semantic used to perform optimal function call
+#else
+#define QUICK						// Naked functions are only available under VCC
+#endif
 
 /********************************************************************
 *																	*
@@ -60,6 +67,16 @@ typedef unsigned long  Dword, * Pdword;
 typedef long FLAGS;		// General flags type
 typedef long RETCODE;	// Return code type
 
+#ifndef _WIN32
+// Windows stand-ins
+typedef int BOOL;	// Boolean type
+
+#define TRUE	1	// Boolean truth
+#define FALSE	0	// Boolean falsehood
+
+#define ZeroMemory(dest,len)	memset((dest), 0, (len))// Clear a region of memory
+#endif
+
 /********************************************************************
 *																	*
 *							Methods									*
@@ -68,6 +85,9 @@ typedef long RETCODE;	// Return code type
 
 typedef RETCODE (* EQUIVAL) (void *, void *);	// Callback function for search comparisons
 typedef RETCODE (* EXECUTE)	(void *, void *);	// Method used for item-wise processing
+typedef void *	(* KEYOF)	(void *);	// Callback function yielding a datum's key
+typedef Dword	(* HASH)	(void *);	// Callback function hashing a key
+typedef void	(* REDUCE)	(void *, void *);	// Callback function folding a worker's result into a context
 
 /********************************************************************
 *																	*